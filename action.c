@@ -36,6 +36,7 @@
 #include "object.h"
 #include "player.h"
 #include "potion.h"
+#include "profile.h"
 #include "savegame.h"
 #include "scroll.h"
 #include "show.h"
@@ -223,17 +224,31 @@ void run(int dir) {
   while (i) {
     i = moveplayer(dir);
     if (i > 0) {
+      profile_begin(PROFILE_MOVEMONST);
       if (c[HASTEMONST])
         movemonst();
 
       movemonst();
+      profile_end();
+
+      profile_begin(PROFILE_SPAWN);
       randmonst();
+      profile_end();
+
+      profile_begin(PROFILE_REGEN);
       regen();
+      profile_end();
     }
     if (hitflag)
       i = 0;
-    if (i != 0)
+    if (i != 0) {
+      profile_begin(PROFILE_SHOWCELL);
       showcell(playerx, playery);
+      profile_end();
+
+      /* each step of the run is a turn */
+      profile_turn();
+    }
   }
 }
 
@@ -430,6 +445,7 @@ void dropobj(void) {
           Print("\nThe gold disappears down the pit.");
         } else
           iarg[playerx][playery] = (short)i;
+        item_update(playerx, playery);
         UpdateStatus();
         dropflag = 1;
         return;
@@ -626,6 +642,7 @@ void closedoor(void) {
           Print("\nYou cannot feel any door there.");
       } else {
         item[dx][dy] = OCLOSEDDOOR;
+        item_update(dx, dy);
         iarg[dx][dy] = 0; /* Clear traps on door */
         Print("\nThe door closes.");
       }
@@ -641,6 +658,7 @@ void closedoor(void) {
     Print("\nThe door closes.");
     forget();
     item[playerx][playery] = OCLOSEDDOOR;
+    item_update(playerx, playery);
     iarg[playerx][playery] = 0;
 
     dropflag = 1; /* So we won't be asked to open it */
@@ -58,4 +58,20 @@
  */
 # define LIBDIR "lib"
 
+/*
+ * GAME_LOCAL:
+ * The storage class for variables holding the state of a game in progress.
+ * Where the compiler supports thread local storage each thread has its own
+ * copy of the game state, so independent games can be run on separate
+ * threads of one process. A new thread starts with the initial game state.
+ * Otherwise there can only be one game per process.
+ */
+# if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L)
+#  define GAME_LOCAL _Thread_local
+# elif defined(__GNUC__)
+#  define GAME_LOCAL __thread
+# else
+#  define GAME_LOCAL
+# endif
+
 #endif
@@ -246,7 +246,7 @@ static char *ivendef[] = {"",
 /*
  * Pointer to the debug output file
  */
-static FILE *dfile;
+static GAME_LOCAL FILE *dfile;
 
 /* =============================================================================
  * Local functions
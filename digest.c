@@ -0,0 +1,210 @@
+/* =============================================================================
+ * PROGRAM:  ularn
+ * FILENAME: digest.c
+ *
+ * DESCRIPTION:
+ * This module computes 64 bit digests (FNV-1a) of the game state.
+ *
+ * =============================================================================
+ * EXPORTED VARIABLES
+ *
+ * None
+ *
+ * =============================================================================
+ * EXPORTED FUNCTIONS
+ *
+ * digest_bytes : Add a block of memory to a digest
+ * digest_game  : Get the digest of the whole game state
+ * digest_state : Get the digest of the live game state
+ *
+ * =============================================================================
+ */
+
+#include <string.h>
+#include <time.h>
+
+#include "digest.h"
+#include "dungeon.h"
+#include "player.h"
+#include "sphere.h"
+
+/* =============================================================================
+ * Local variables
+ */
+
+#define DIGEST_PRIME 0x100000001b3ULL
+
+/*
+ * The live state is divided into blocks: each column of each level array,
+ * the player attributes and the inventory. The digest of the blocks is the
+ * XOR of the digests of each block, so a changed block is updated by
+ * removing its old digest and adding the new one.
+ *
+ * Changes to the level arrays are made all over the game, so changed
+ * blocks are found by comparing with a copy of the state at the last call.
+ * The items carried by monsters are part of the monster blocks, which are
+ * all hashed again when stolen_changes shows the stolen item table has
+ * changed.
+ */
+typedef enum {
+  BLOCK_ITEM,
+  BLOCK_KNOW,
+  BLOCK_HITP,
+  BLOCK_IARG,
+  BLOCK_MITEM,
+  BLOCK_LEVEL_ARRAYS
+} BlockType;
+
+/*
+ * Block numbers for the level arrays are BlockType * MAXX + column, followed
+ * by the blocks for c[], iven and ivenarg.
+ */
+#define LEVEL_BLOCKS (BLOCK_LEVEL_ARRAYS * MAXX)
+#define NUM_BLOCKS (LEVEL_BLOCKS + 3)
+
+static GAME_LOCAL int StateValid = 0;
+static GAME_LOCAL DigestType BlockDigest[NUM_BLOCKS];
+static GAME_LOCAL DigestType StateDigest;
+
+/*
+ * The copy of the state at the last call to digest_state
+ */
+static GAME_LOCAL char OldItem[MAXX][MAXY];
+static GAME_LOCAL char OldKnow[MAXX][MAXY];
+static GAME_LOCAL short OldHitp[MAXX][MAXY];
+static GAME_LOCAL short OldIarg[MAXX][MAXY];
+static GAME_LOCAL struct_mitem OldMitem[MAXX][MAXY];
+static GAME_LOCAL unsigned long OldStolenChanges;
+static GAME_LOCAL long OldC[ATTRIBUTE_COUNT];
+static GAME_LOCAL char OldIven[IVENSIZE];
+static GAME_LOCAL short OldIvenarg[IVENSIZE];
+
+/* =============================================================================
+ * Local functions
+ */
+
+/* =============================================================================
+ * FUNCTION: update_block
+ *
+ * DESCRIPTION:
+ * Update the digest of a block if it has changed since the last call to
+ * digest_state.
+ *
+ * PARAMETERS:
+ *
+ *   Block : The block number
+ *
+ *   Old   : The copy of the block at the last call
+ *
+ *   Live  : The block
+ *
+ *   Len   : The size of the block in bytes
+ *
+ *   Force : Set if the block is to be hashed again even if it hasn't changed
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+static void update_block(int Block, void *Old, const void *Live, long Len,
+                         int Force) {
+  DigestType Digest;
+
+  if (StateValid && !Force && (memcmp(Old, Live, Len) == 0))
+    return;
+
+  memcpy(Old, Live, Len);
+
+  //
+  // Start from the block number so that equal blocks in different places
+  // have different digests and don't cancel out.
+  //
+  Digest = DIGEST_INIT ^ (DigestType)Block;
+
+  if (Block / MAXX == BLOCK_MITEM)
+    Digest =
+        digest_mitem(Digest, (struct_mitem *)Live, stolen, Block % MAXX);
+  else
+    Digest = digest_bytes(Digest, Live, Len);
+
+  StateDigest ^= BlockDigest[Block] ^ Digest;
+  BlockDigest[Block] = Digest;
+}
+
+/* =============================================================================
+ * Exported functions
+ */
+
+/* =============================================================================
+ * FUNCTION: digest_bytes
+ */
+DigestType digest_bytes(DigestType Digest, const void *Data, long Len) {
+  const unsigned char *p = (const unsigned char *)Data;
+
+  while (Len-- > 0) {
+    Digest ^= *p++;
+    Digest *= DIGEST_PRIME;
+  }
+
+  return Digest;
+}
+
+/* =============================================================================
+ * FUNCTION: digest_game
+ */
+DigestType digest_game(void) {
+  DigestType Digest;
+
+  Digest = DIGEST_INIT;
+  Digest = digest_bytes(Digest, c, sizeof(c));
+  Digest = digest_bytes(Digest, iven, sizeof(iven));
+  Digest = digest_bytes(Digest, ivenarg, sizeof(ivenarg));
+  Digest = digest_bytes(Digest, &gtime, sizeof(gtime));
+  Digest = digest_bytes(Digest, &level, sizeof(level));
+
+  return digest_levels(Digest);
+}
+
+/* =============================================================================
+ * FUNCTION: digest_state
+ */
+DigestType digest_state(void) {
+  DigestType Digest;
+  int StolenChanged;
+  int x;
+
+  if (!StateValid) {
+    memset(BlockDigest, 0, sizeof(BlockDigest));
+    StateDigest = 0;
+  }
+
+  StolenChanged = (OldStolenChanges != stolen_changes);
+  OldStolenChanges = stolen_changes;
+
+  for (x = 0; x < MAXX; x++) {
+    update_block(BLOCK_ITEM * MAXX + x, OldItem[x], item[x], sizeof(item[x]),
+                 0);
+    update_block(BLOCK_KNOW * MAXX + x, OldKnow[x], know[x], sizeof(know[x]),
+                 0);
+    update_block(BLOCK_HITP * MAXX + x, OldHitp[x], hitp[x], sizeof(hitp[x]),
+                 0);
+    update_block(BLOCK_IARG * MAXX + x, OldIarg[x], iarg[x], sizeof(iarg[x]),
+                 0);
+    update_block(BLOCK_MITEM * MAXX + x, OldMitem[x], mitem[x],
+                 sizeof(mitem[x]), StolenChanged);
+  }
+
+  update_block(LEVEL_BLOCKS, OldC, c, sizeof(c), 0);
+  update_block(LEVEL_BLOCKS + 1, OldIven, iven, sizeof(iven), 0);
+  update_block(LEVEL_BLOCKS + 2, OldIvenarg, ivenarg, sizeof(ivenarg), 0);
+
+  StateValid = 1;
+
+  //
+  // The level, time and spheres are small enough to add each time
+  //
+  Digest = digest_bytes(StateDigest, &level, sizeof(level));
+  Digest = digest_bytes(Digest, &gtime, sizeof(gtime));
+
+  return digest_spheres(Digest);
+}
@@ -0,0 +1,97 @@
+/* =============================================================================
+ * PROGRAM:  ularn
+ * FILENAME: digest.h
+ *
+ * DESCRIPTION:
+ * This module computes 64 bit digests (FNV-1a) of the game state.
+ * The digests are used to check that a replayed game ends in exactly the
+ * same state as the game that was recorded, and to find where two runs of
+ * a game diverge.
+ *
+ * digest_state is cheap enough to call every turn: it keeps a copy of the
+ * live state and only hashes again the parts that changed since the last
+ * call.
+ *
+ * =============================================================================
+ * EXPORTED VARIABLES
+ *
+ * None
+ *
+ * =============================================================================
+ * EXPORTED FUNCTIONS
+ *
+ * digest_bytes : Add a block of memory to a digest
+ * digest_game  : Get the digest of the whole game state
+ * digest_state : Get the digest of the live game state
+ *
+ * =============================================================================
+ */
+
+#ifndef __DIGEST_H
+# define __DIGEST_H
+
+/*
+ * The starting value of a digest
+ */
+# define DIGEST_INIT 0xcbf29ce484222325ULL
+
+typedef unsigned long long DigestType;
+
+/* =============================================================================
+ * FUNCTION: digest_bytes
+ *
+ * DESCRIPTION:
+ * Add a block of memory to a digest.
+ *
+ * PARAMETERS:
+ *
+ *   Digest : The digest so far.
+ *
+ *   Data   : The memory to add.
+ *
+ *   Len    : The number of bytes to add.
+ *
+ * RETURN VALUE:
+ *
+ *   The updated digest.
+ */
+DigestType digest_bytes(DigestType Digest, const void *Data, long Len);
+
+/* =============================================================================
+ * FUNCTION: digest_game
+ *
+ * DESCRIPTION:
+ * Get the digest of the whole game state: the player attributes, inventory,
+ * game time, current level and the contents of every level visited.
+ *
+ * PARAMETERS:
+ *
+ *   None.
+ *
+ * RETURN VALUE:
+ *
+ *   The digest of the game state.
+ */
+DigestType digest_game(void);
+
+/* =============================================================================
+ * FUNCTION: digest_state
+ *
+ * DESCRIPTION:
+ * Get the digest of the live game state: the current level, the player
+ * attributes, inventory, game time and the spheres of annihilation.
+ * The stored copies of other levels are not included.
+ * Only the parts of the state that changed since the last call are hashed
+ * again.
+ *
+ * PARAMETERS:
+ *
+ *   None.
+ *
+ * RETURN VALUE:
+ *
+ *   The digest of the live game state.
+ */
+DigestType digest_state(void);
+
+#endif
@@ -11,12 +11,16 @@
  *
  * item      : The item at each location on the current level
  * know      : What the player beleives is at each location
- * moved     : The monster moved status for each dungeon location
+ * moved     : The monster move pass for each dungeon location
  * stealth   : The monster stealth status for each dungeon location
  * hitp      : The monster hit points for each dungeon location
  * iarg      : The item arg for each dungeon location
- * screen    : Screen data used in moving monsters
- * mitem     : The monster and items it has stolen for each dungeon location
+ * mitem     : The monster at each dungeon location
+ * stolen    : The items carried by monsters on the current level
+ * stolen_changes : Counts changes to the items carried by monsters
+ * roster    : The locations of the monsters on the current level
+ * roster_count : The number of monsters on the current level
+ * monster_mask : The locations of the monsters in each column as bit masks
  * beenhere  : Which dungeon levels have been visited
  * level     : The current dungeon level
  * levelname : The name of each dungeon level
@@ -26,6 +30,7 @@
  *
  * init_cells     : Allocate dungeon storage
  * free_cells     : Free dungeon storage
+ * level_storage_size : Get the memory used by dungeon storage
  * cgood          : Check if a cell is empty (monster and/or item)
  * dropgold       : Drop gold around the player
  * fillmonst      : Attempt to put a monster into the dungeon
@@ -40,12 +45,30 @@
  * newobject      : Return a randomly selected item
  * write_levels   : Write dungeon levels to the save file
  * read_levels    : Read dungeon levels from the save file
+ * digest_mitem   : Add monsters and stolen items to a digest
+ * digest_levels  : Add the current and visited levels to a digest
+ * roster_rebuild : Make the monster roster from the current level
+ * roster_update  : Update the monster roster for a location
+ * roster_scan_start : Start a scan of the monsters in a window
+ * roster_scan_next  : Get the next monster location in a scan
+ * pick_empty_cell   : Pick a random empty location on the current level
+ * item_update       : Note that the item at a location has changed
+ * stolen_count : Get the number of items a monster is carrying
+ * stolen_items : Get the items a monster is carrying
+ * stolen_full  : Check if a monster can carry any more items
+ * stolen_add   : Give a monster an item to carry
+ * stolen_move  : Move the items a monster is carrying with the monster
+ * stolen_remove : Take away all the items a monster is carrying
+ * stolen_copy  : Copy a stolen item table
+ * stolen_free  : Free the entries of a stolen item table
  *
  * =============================================================================
  */
 
 #include <stdio.h>
+#include <string.h>
 
+#include "digest.h"
 #include "dungeon.h"
 #include "header.h"
 #include "itm.h"
@@ -62,19 +85,24 @@
  * Exported variables
  */
 
-char item[MAXX][MAXY];          /* objects in maze if any */
-char know[MAXX][MAXY];          /* 1 or 0 if here before  */
-char moved[MAXX][MAXY];         /* monster movement flags  */
-char stealth[MAXX][MAXY];       /* See Stealth flags */
-short hitp[MAXX][MAXY];         /* monster hp on level  */
-short iarg[MAXX][MAXY];         /* arg for the item array */
-short screen[MAXX][MAXY];       /* The screen as the player knows it */
-struct_mitem mitem[MAXX][MAXY]; /* Items stolen by monstes array */
-
-char beenhere[NLEVELS] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+GAME_LOCAL char (*item)[MAXY];             /* objects in maze if any */
+GAME_LOCAL char (*know)[MAXY];             /* 1 or 0 if here before  */
+GAME_LOCAL unsigned int moved[MAXX][MAXY]; /* monster move pass */
+GAME_LOCAL char stealth[MAXX][MAXY];       /* See Stealth flags */
+GAME_LOCAL short (*hitp)[MAXY];            /* monster hp on level  */
+GAME_LOCAL short (*iarg)[MAXY];            /* arg for the item array */
+GAME_LOCAL struct_mitem (*mitem)[MAXY];    /* monster on level */
+GAME_LOCAL Stolen_Table *stolen;           /* items carried by monsters */
+GAME_LOCAL unsigned long stolen_changes;   /* changes to stolen */
+
+GAME_LOCAL RosterEntry roster[MAXX * MAXY];
+GAME_LOCAL int roster_count = 0;
+GAME_LOCAL unsigned int monster_mask[MAXX];
+
+GAME_LOCAL char beenhere[NLEVELS] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
                           0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
 
-int level = 0; /* cavelevel player is on = c[CAVELEVEL]*/
+GAME_LOCAL int level = 0; /* cavelevel player is on = c[CAVELEVEL]*/
 
 char *levelname[] = {" H", " 1", " 2", " 3", " 4", " 5", " 6",
                      " 7", " 8", " 9", "10", "11", "12", "13",
@@ -84,6 +112,37 @@ char *levelname[] = {" H", " 1", " 2", " 3", " 4", " 5", " 6",
  * Local variables
  */
 
+/*
+ * The roster entry for each location, plus one. 0 means there is no entry.
+ */
+static GAME_LOCAL short RosterIndex[MAXX][MAXY];
+
+/*
+ * The current roster scan.
+ * ScanList holds the locations still to be visited as y * MAXX + x, in
+ * increasing order from ScanHead to ScanTail. ScanLast is the location last
+ * visited, or -1 if none has been.
+ */
+static GAME_LOCAL int ScanActive = 0;
+static GAME_LOCAL int ScanXl, ScanYl, ScanXh, ScanYh;
+static GAME_LOCAL short ScanList[MAXX * MAXY];
+static GAME_LOCAL int ScanHead, ScanTail;
+static GAME_LOCAL int ScanLast;
+
+/*
+ * The index of empty locations (no item and no monster) on the current level,
+ * not counting the outer border.
+ * EmptyList holds the locations as y * MAXX + x, in no particular order, and
+ * EmptyIndex is the entry for each location, plus one (0 means the location
+ * is not in the index).
+ * Changes are applied as they happen through roster_update and item_update,
+ * and the index is made again when the whole level is replaced.
+ */
+static GAME_LOCAL int EmptyValid = 0;
+static GAME_LOCAL int EmptyCount;
+static GAME_LOCAL short EmptyList[MAXX * MAXY];
+static GAME_LOCAL short EmptyIndex[MAXX][MAXY];
+
 /*
  * Data and macros for finding the number of +s for items.
  */
@@ -138,11 +197,94 @@ typedef struct save_lev_str {
   Char_Ary know;
 } Saved_Level;
 
-static Saved_Level *saved_levels[NLEVELS] = {
+/*
+ * The save file holds each level as it was stored when every location had
+ * room for the items a monster there was carrying.
+ */
+typedef struct {
+  char mon;
+  char n;
+  StolenItem it[MAX_STOLEN];
+} Legacy_Mitem;
+
+typedef struct {
+  Short_Ary hitp;
+  Legacy_Mitem mitem[MAXX][MAXY];
+  Char_Ary item;
+  Short_Ary iarg;
+  Char_Ary know;
+} Legacy_Level;
+
+static GAME_LOCAL Saved_Level *saved_levels[NLEVELS] = {
     NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
     NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL};
 
-static unsigned int level_sums[NLEVELS];
+/*
+ * The items carried by monsters on each level. These are kept apart from the
+ * rest of the level storage, so they stay where they are when a level is
+ * packed.
+ */
+static GAME_LOCAL Stolen_Table level_stolen[NLEVELS];
+
+/*
+ * The number of entries a stolen item table starts with when a monster on
+ * the level first carries an item
+ */
+#define STOLEN_TABLE_START 8
+
+/*
+ * The packed copy of each level the player isn't on, when levels are packed
+ * (pack_levels). A packed level has no other storage.
+ * A level is packed a word (PACK_WORD bytes) at a time, with the last word
+ * padded with zeroes. Each word starts with a tag byte with bit i set if
+ * byte i of the word isn't zero, followed by the bytes that aren't zero.
+ * If all or none of the bytes are zero this is followed by the number of
+ * copies of the word that come next (up to PACK_MAX_REPEAT).
+ * Most of a level is zero (empty locations, no monsters and unknown
+ * locations), so this is several times smaller than the level.
+ */
+static GAME_LOCAL unsigned char *packed_levels[NLEVELS];
+static GAME_LOCAL long packed_sizes[NLEVELS];
+
+typedef unsigned long long PackWord;
+
+#define PACK_WORD ((long)sizeof(PackWord))
+#define PACK_LEN \
+  ((((long)sizeof(Saved_Level) + PACK_WORD - 1) / PACK_WORD) * PACK_WORD)
+#define PACK_ALL_SET 0xff
+#define PACK_MAX_REPEAT 255
+
+/*
+ * The checksum of each level when it was last put into storage.
+ * level_sum_valid is 0 if the level has no checksum, because the player has
+ * been on it since or it has just been read from the save file.
+ */
+static GAME_LOCAL unsigned int level_sums[NLEVELS];
+static GAME_LOCAL char level_sum_valid[NLEVELS];
+
+/*
+ * The level arrays point at this empty level until the first level is
+ * entered, so things looking at the map during setup find nothing there.
+ */
+static GAME_LOCAL Saved_Level no_level;
+static GAME_LOCAL Stolen_Table no_stolen;
+
+/*
+ * The game time at which each level was last put into storage
+ */
+static GAME_LOCAL long level_times[NLEVELS];
+
+/*
+ * Catch up rates for levels the player has been away from:
+ *   CATCHUP_REGEN_TURNS  : turns for a monster to regain 1 hit point
+ *   CATCHUP_WANDER_TURNS : turns for each step a monster wanders
+ *   CATCHUP_WANDER_STEPS : the most steps a monster wanders
+ *   CATCHUP_SPAWNS       : the most random monsters created
+ */
+#define CATCHUP_REGEN_TURNS 20
+#define CATCHUP_WANDER_TURNS 10
+#define CATCHUP_WANDER_STEPS 8
+#define CATCHUP_SPAWNS 10
 
 /* =============================================================================
  * Local functions
@@ -279,8 +421,10 @@ static int cannedlevel(int lev) {
         break;
       }
       item[j][i] = (char)it;
+      item_update(j, i);
       iarg[j][i] = (short)arg;
       mitem[j][i].mon = (char)Monst;
+      roster_update(j, i);
       hitp[j][i] = (short)marg;
       know[j][i] = (char)((wizard) ? item[j][i] : OUNKNOWN);
     }
@@ -321,22 +465,29 @@ static void troom(int lv, int xsize, int ysize, int tx, int ty, int glyph) {
   int bupx, bupy;
 
   /* clear out space for room */
-  for (j = (ty - 1); j <= (ty + ysize); j++)
-    for (i = (tx - 1); i <= (tx + xsize); i++)
+  for (j = (ty - 1); j <= (ty + ysize); j++) {
+    for (i = (tx - 1); i <= (tx + xsize); i++) {
       item[i][j] = ONOTHING;
+      item_update(i, j);
+    }
+  }
 
   /* now put in the walls */
   for (j = ty; j < (ty + ysize); j++) {
     for (i = tx; i < (tx + xsize); i++) {
       item[i][j] = OWALL;
       mitem[i][j].mon = MONST_NONE;
+      roster_update(i, j);
     }
   }
 
   /* now clear out interior */
-  for (j = (ty + 1); j < (ty + ysize - 1); j++)
-    for (i = (tx + 1); i < (tx + xsize - 1); i++)
+  for (j = (ty + 1); j < (ty + ysize - 1); j++) {
+    for (i = (tx + 1); i < (tx + xsize - 1); i++) {
       item[i][j] = ONOTHING;
+      item_update(i, j);
+    }
+  }
 
   /* locate the door on the treasure room */
   switch (rnd(2)) {
@@ -344,12 +495,14 @@ static void troom(int lv, int xsize, int ysize, int tx, int ty, int glyph) {
     i = tx + rund(xsize);
     j = ty + (ysize - 1) * rund(2);
     item[i][j] = OCLOSEDDOOR;
+    item_update(i, j);
     iarg[i][j] = (short)glyph; /* on horizontal walls */
     break;
   case 2:
     i = tx + (xsize - 1) * rund(2);
     j = ty + rund(ysize);
     item[i][j] = OCLOSEDDOOR;
+    item_update(i, j);
     iarg[i][j] = (short)glyph; /* on vertical walls */
     break;
   }
@@ -456,6 +609,7 @@ static void fillroom(int what, int arg) {
       y = MAXY - 2;
   }
   item[x][y] = (char)what;
+  item_update(x, y);
   iarg[x][y] = (short)arg;
 }
 
@@ -770,9 +924,7 @@ static void sethp(int flg) {
 
   if (flg) {
     /* All initial monsters are unseen and asleep */
-    for (i = 0; i < MAXY; i++)
-      for (j = 0; j < MAXX; j++)
-        stealth[j][i] = 0;
+    memset(stealth, 0, sizeof(stealth));
   }
 
   if (level == 0)
@@ -805,8 +957,7 @@ static void sethp(int flg) {
     if ((level >= (DBOTTOM - 4)) && (level <= DBOTTOM)) {
       i = level - 10;
       for (j = 1; j <= i; j++)
-        while (fillmonst(DEMONLORD + rund(7)) == -1)
-          ;
+        fillmonst(DEMONLORD + rund(7));
     }
 
     /*
@@ -819,9 +970,7 @@ static void sethp(int flg) {
     if (level > DBOTTOM) {
       i = level - DBOTTOM;
       for (j = 1; j <= i; j++)
-        /* Keep trying until the demon prince has been placed */
-        while (fillmonst(DEMONPRINCE) == -1)
-          ;
+        fillmonst(DEMONPRINCE);
     }
   }
 }
@@ -841,17 +990,192 @@ static void sethp(int flg) {
  *   None.
  */
 static void checkgen(void) {
+  int i;
   int x, y;
 
-  for (y = 0; y < MAXY; y++) {
-    for (x = 0; x < MAXX; x++) {
-      if ((monster[(int)mitem[x][y].mon].flags & FL_GENOCIDED) != 0) {
-        mitem[x][y].mon = 0; /* no more monster */
-      }
+  /*
+   * Go backwards through the roster as removing a monster moves the last
+   * entry into its place.
+   */
+  for (i = roster_count - 1; i >= 0; i--) {
+    x = roster[i].x;
+    y = roster[i].y;
+    if ((monster[(int)mitem[x][y].mon].flags & FL_GENOCIDED) != 0) {
+      mitem[x][y].mon = 0; /* no more monster */
+      roster_update(x, y);
     }
   }
 }
 
+/* =============================================================================
+ * FUNCTION: update_empty
+ *
+ * DESCRIPTION:
+ * Add or remove a location from the index of empty locations.
+ *
+ * PARAMETERS:
+ *
+ *   x : The x coordinate of the location
+ *
+ *   y : The y coordinate of the location
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+static void update_empty(int x, int y) {
+  int i;
+  int empty;
+
+  if (!EmptyValid || (x < 1) || (x >= MAXX - 1) || (y < 1) || (y >= MAXY - 1))
+    return;
+
+  empty = (item[x][y] == ONOTHING) && (mitem[x][y].mon == MONST_NONE);
+  i = EmptyIndex[x][y];
+
+  if (empty && (i == 0)) {
+    EmptyList[EmptyCount++] = (short)(y * MAXX + x);
+    EmptyIndex[x][y] = (short)EmptyCount;
+  } else if (!empty && (i != 0)) {
+    /* move the last entry into the removed entry's place */
+    EmptyCount--;
+    EmptyList[i - 1] = EmptyList[EmptyCount];
+    EmptyIndex[EmptyList[i - 1] % MAXX][EmptyList[i - 1] / MAXX] = (short)i;
+    EmptyIndex[x][y] = 0;
+  }
+}
+
+/* =============================================================================
+ * FUNCTION: make_empty_index
+ *
+ * DESCRIPTION:
+ * Make the index of empty locations from the current level.
+ *
+ * PARAMETERS:
+ *
+ *   None.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+static void make_empty_index(void) {
+  int x, y;
+
+  memset(EmptyIndex, 0, sizeof(EmptyIndex));
+  EmptyCount = 0;
+  EmptyValid = 1;
+
+  for (y = 1; y < MAXY - 1; y++)
+    for (x = 1; x < MAXX - 1; x++)
+      update_empty(x, y);
+}
+
+/* =============================================================================
+ * FUNCTION: wander
+ *
+ * DESCRIPTION:
+ * Make a monster take random steps to empty locations, avoiding traps and
+ * other items.
+ *
+ * PARAMETERS:
+ *
+ *   x     : The x coordinate of the monster
+ *
+ *   y     : The y coordinate of the monster
+ *
+ *   steps : The number of steps to try
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+static void wander(int x, int y, int steps) {
+  int nx, ny;
+  int z;
+
+  while (steps-- > 0) {
+    z = rnd(8);
+    nx = x + diroffx[z];
+    ny = y + diroffy[z];
+
+    if ((nx < 1) || (nx >= MAXX - 1) || (ny < 1) || (ny >= MAXY - 1) ||
+        !cgood(nx, ny, 1, 1))
+      continue;
+
+    mitem[nx][ny] = mitem[x][y];
+    hitp[nx][ny] = hitp[x][y];
+    stealth[nx][ny] = stealth[x][y];
+    memset(&mitem[x][y], 0, sizeof(mitem[x][y]));
+    stolen_move(x, y, nx, ny);
+    hitp[x][y] = 0;
+    stealth[x][y] = 0;
+
+    /* the monster keeps its roster entry */
+    roster_update(nx, ny);
+    roster_update(x, y);
+
+    x = nx;
+    y = ny;
+  }
+}
+
+/* =============================================================================
+ * FUNCTION: catchup_level
+ *
+ * DESCRIPTION:
+ * Bring the current level up to date for the time the player was away.
+ * Rather than playing out each turn, the monsters regenerate and wander in
+ * one go and the random monsters randmonst would have made are created,
+ * so the cost depends on the number of monsters and not the time away.
+ *
+ * PARAMETERS:
+ *
+ *   elapsed : The number of turns the player was away
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+static void catchup_level(long elapsed) {
+  long regen;
+  int steps;
+  int spawns;
+  int maxhp;
+  int i;
+  int x, y;
+  MonsterIdType monst;
+
+  if (elapsed <= 0)
+    return;
+
+  steps = (int)((elapsed / CATCHUP_WANDER_TURNS < CATCHUP_WANDER_STEPS)
+                    ? elapsed / CATCHUP_WANDER_TURNS
+                    : CATCHUP_WANDER_STEPS);
+
+  for (i = 0; i < roster_count; i++) {
+    x = roster[i].x;
+    y = roster[i].y;
+    monst = mitem[x][y].mon;
+
+    /* trolls regenerate every other turn, as they do when they move */
+    regen = (monst == TROLL) ? elapsed / 2 : elapsed / CATCHUP_REGEN_TURNS;
+    maxhp = monster[monst].hitpoints;
+    if (hitp[x][y] < maxhp)
+      hitp[x][y] = (short)((hitp[x][y] + regen < maxhp) ? hitp[x][y] + regen
+                                                        : maxhp);
+
+    wander(x, y, steps);
+  }
+
+  /* randmonst makes a monster every 120 - 4 * level turns */
+  spawns = (int)((elapsed / (120 - (level << 2)) < CATCHUP_SPAWNS)
+                     ? elapsed / (120 - (level << 2))
+                     : CATCHUP_SPAWNS);
+  for (i = 0; i < spawns; i++)
+    fillmonst(makemonst(level));
+}
+
 /* =============================================================================
  * FUNCTION: makemaze
  *
@@ -887,9 +1211,7 @@ static void makemaze(int lev) {
     tmp = OWALL;
 
   /* fill up maze */
-  for (i = 0; i < MAXY; i++)
-    for (j = 0; j < MAXX; j++)
-      item[j][i] = (char)tmp;
+  memset(item, tmp, sizeof(Char_Ary));
 
   /* don't need to do anymore for level 0 */
   if (lev == 0)
@@ -921,8 +1243,10 @@ static void makemaze(int lev) {
       for (i = mxl; i < mxh; i++) {
         for (j = myl; j < myh; j++) {
           item[i][j] = ONOTHING;
+          item_update(i, j);
           if (Monst != MONST_NONE) {
             mitem[i][j].mon = (char)Monst;
+            roster_update(i, j);
             hitp[i][j] = monster[Monst].hitpoints;
           }
         }
@@ -932,8 +1256,10 @@ static void makemaze(int lev) {
 
   if (lev != DBOTTOM && lev != VBOTTOM) {
     my = rnd(MAXY - 2);
-    for (i = 1; i < MAXX - 1; i++)
+    for (i = 1; i < MAXX - 1; i++) {
       item[i][my] = ONOTHING;
+      item_update(i, my);
+    }
   }
 
   /* no treasure rooms above level 5 */
@@ -942,104 +1268,654 @@ static void makemaze(int lev) {
 }
 
 /* =============================================================================
- * Exported functions
+ * FUNCTION: digest_level
+ *
+ * DESCRIPTION:
+ * Add the contents of a dungeon level to a digest.
+ *
+ * PARAMETERS:
+ *
+ *   Digest   : The digest so far
+ *
+ *   LevHitp  : The monster hit points for the level
+ *
+ *   LevMitem : The monsters for the level
+ *
+ *   LevItem  : The items for the level
+ *
+ *   LevIarg  : The item args for the level
+ *
+ *   LevKnow  : What the player knows of the level
+ *
+ *   LevStolen : The items carried by monsters on the level
+ *
+ * RETURN VALUE:
+ *
+ *   The updated digest.
  */
+static DigestType digest_level(DigestType Digest, Short_Ary LevHitp,
+                               Mitem_Ary LevMitem, Char_Ary LevItem,
+                               Short_Ary LevIarg, Char_Ary LevKnow,
+                               Stolen_Table *LevStolen) {
+  int x;
 
-/* =============================================================================
- * FUNCTION: init_cells
- */
-void init_cells(void) {
-  int i;
+  Digest = digest_bytes(Digest, LevHitp, sizeof(Short_Ary));
+  Digest = digest_bytes(Digest, LevItem, sizeof(Char_Ary));
+  Digest = digest_bytes(Digest, LevIarg, sizeof(Short_Ary));
+  Digest = digest_bytes(Digest, LevKnow, sizeof(Char_Ary));
 
-  for (i = 0; i < NLEVELS; i++) {
-    if ((saved_levels[i] = (Saved_Level *)malloc(sizeof(Saved_Level))) ==
-        (Saved_Level *)NULL)
-      died(DIED_MALLOC_FAILURE, 0);
-  }
+  for (x = 0; x < MAXX; x++)
+    Digest = digest_mitem(Digest, LevMitem[x], LevStolen, x);
+
+  return Digest;
 }
 
 /* =============================================================================
- * FUNCTION: free_cells
+ * FUNCTION: find_stolen
+ *
+ * DESCRIPTION:
+ * Find the entry in a stolen item table for the monster at a location.
+ *
+ * PARAMETERS:
+ *
+ *   Stolen : The stolen item table
+ *
+ *   x      : The x coordinate of the monster
+ *
+ *   y      : The y coordinate of the monster
+ *
+ * RETURN VALUE:
+ *
+ *   The index of the entry, or -1 if the monster isn't carrying anything.
  */
-void free_cells(void) {
+static int find_stolen(Stolen_Table *Stolen, int x, int y) {
   int i;
 
-  for (i = 0; i < NLEVELS; i++)
-    if (saved_levels[i] != (Saved_Level *)NULL)
-      free(saved_levels[i]);
+  for (i = 0; i < Stolen->count; i++)
+    if ((Stolen->set[i].x == x) && (Stolen->set[i].y == y))
+      return i;
+
+  return -1;
 }
 
 /* =============================================================================
- * FUNCTION: cgood
+ * FUNCTION: new_stolen_set
+ *
+ * DESCRIPTION:
+ * Add an empty entry to a stolen item table for the monster at a location,
+ * growing the table if it is full.
+ *
+ * PARAMETERS:
+ *
+ *   Stolen : The stolen item table
+ *
+ *   x      : The x coordinate of the monster
+ *
+ *   y      : The y coordinate of the monster
+ *
+ * RETURN VALUE:
+ *
+ *   The new entry.
  */
-int cgood(int x, int y, int chkitm, int chkmonst) {
-  int good = 0;
+static StolenSet *new_stolen_set(Stolen_Table *Stolen, int x, int y) {
+  StolenSet *set;
+  int size;
+
+  if (Stolen->count == Stolen->size) {
+    size = (Stolen->size == 0) ? STOLEN_TABLE_START : 2 * Stolen->size;
+    set = (StolenSet *)realloc(Stolen->set, size * sizeof(StolenSet));
+    if (set == (StolenSet *)NULL)
+      died(DIED_MALLOC_FAILURE, 0);
 
-  if ((y >= 0) && (y <= MAXY - 1) && (x >= 0) &&
-      (x <= MAXX - 1)) { /* within bounds? */
-    if ((level == 1) && (x == 33) && (y == MAXY - 1))
-      /* exit to level 1 is never good */
-      return 0;
+    Stolen->set = set;
+    Stolen->size = size;
+  }
 
-    if ((item[x][y] == OWALL) || (item[x][y] == OCLOSEDDOOR))
-      /* can't make on walls or closed doors */
-      return 0;
+  set = &Stolen->set[Stolen->count++];
+  set->x = (char)x;
+  set->y = (char)y;
+  set->n = 0;
 
-    /* Location is OK so far */
-    good = 1;
+  return set;
+}
 
-    if (chkitm && (item[x][y] != ONOTHING))
-      /* checking items and it is not free of items */
-      good = 0;
+/* =============================================================================
+ * FUNCTION: save_legacy_level
+ *
+ * DESCRIPTION:
+ * Make the save file copy of a stored level.
+ *
+ * PARAMETERS:
+ *
+ *   Legacy  : The save file copy to make
+ *
+ *   storage : The stored level
+ *
+ *   Stolen  : The items carried by monsters on the level
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+static void save_legacy_level(Legacy_Level *Legacy, Saved_Level *storage,
+                              Stolen_Table *Stolen) {
+  StolenSet *set;
+  int x, y;
+  int i;
 
-    if (chkmonst && (mitem[x][y].mon != MONST_NONE))
-      /* checking for monsters and not free of monsters */
-      good = 0;
+  memset(Legacy, 0, sizeof(Legacy_Level));
+  memcpy(Legacy->hitp, storage->hitp, sizeof(Short_Ary));
+  memcpy(Legacy->item, storage->item, sizeof(Char_Ary));
+  memcpy(Legacy->iarg, storage->iarg, sizeof(Short_Ary));
+  memcpy(Legacy->know, storage->know, sizeof(Char_Ary));
+
+  for (x = 0; x < MAXX; x++)
+    for (y = 0; y < MAXY; y++)
+      Legacy->mitem[x][y].mon = storage->mitem[x][y].mon;
+
+  for (i = 0; i < Stolen->count; i++) {
+    set = &Stolen->set[i];
+    Legacy->mitem[(int)set->x][(int)set->y].n = set->n;
+    memcpy(Legacy->mitem[(int)set->x][(int)set->y].it, set->it,
+           sizeof(set->it));
   }
-
-  return good;
 }
 
 /* =============================================================================
- * FUNCTION: dropgold
+ * FUNCTION: load_legacy_level
+ *
+ * DESCRIPTION:
+ * Store a level read from the save file.
+ *
+ * PARAMETERS:
+ *
+ *   storage : The level storage
+ *
+ *   Stolen  : The table for the items carried by monsters on the level
+ *
+ *   Legacy  : The save file copy of the level
+ *
+ * RETURN VALUE:
+ *
+ *   None.
  */
-void dropgold(int amount) {
-  if (amount > 250)
-    createitem(playerx, playery, OMAXGOLD, (long)amount);
-  else
-    createitem(playerx, playery, OGOLDPILE, (long)amount);
+static void load_legacy_level(Saved_Level *storage, Stolen_Table *Stolen,
+                              Legacy_Level *Legacy) {
+  Legacy_Mitem *cell;
+  StolenSet *set;
+  int x, y;
+  int n;
+
+  memset(storage, 0, sizeof(Saved_Level));
+  Stolen->count = 0;
+  memcpy(storage->hitp, Legacy->hitp, sizeof(Short_Ary));
+  memcpy(storage->item, Legacy->item, sizeof(Char_Ary));
+  memcpy(storage->iarg, Legacy->iarg, sizeof(Short_Ary));
+  memcpy(storage->know, Legacy->know, sizeof(Char_Ary));
+
+  for (x = 0; x < MAXX; x++) {
+    for (y = 0; y < MAXY; y++) {
+      cell = &Legacy->mitem[x][y];
+      storage->mitem[x][y].mon = cell->mon;
+
+      /*
+       * Items left at a location by a monster that has gone aren't carried
+       * by anything, so they go with the monster.
+       */
+      n = (cell->mon == MONST_NONE) ? 0 : cell->n;
+      if (n > MAX_STOLEN)
+        n = MAX_STOLEN;
+
+      if (n > 0) {
+        set = new_stolen_set(Stolen, x, y);
+        set->n = (char)n;
+        memcpy(set->it, cell->it, n * sizeof(StolenItem));
+      }
+    }
+  }
 }
 
 /* =============================================================================
- * FUNCTION: fillmonst
+ * FUNCTION: level_storage
+ *
+ * DESCRIPTION:
+ * Get the storage for a level, allocating it if the level has none.
+ *
+ * PARAMETERS:
+ *
+ *   lev : The dungeon level
+ *
+ * RETURN VALUE:
+ *
+ *   The storage for the level.
  */
-int fillmonst(int what) {
-  int x, y, trys;
-
-  /* max # of creation attempts */
-  for (trys = 10; trys > 0; --trys) {
-    x = rnd(MAXX - 2);
-    y = rnd(MAXY - 2);
-
-    if ((item[x][y] == ONOTHING) && (mitem[x][y].mon == MONST_NONE) &&
-        ((playerx != x) || (playery != y))) {
-      mitem[x][y].mon = (char)what;
-      stealth[x][y] = 0;
-      hitp[x][y] = monster[what].hitpoints;
-      return 0;
-    }
+static Saved_Level *level_storage(int lev) {
+  if (saved_levels[lev] == (Saved_Level *)NULL) {
+    if ((saved_levels[lev] = (Saved_Level *)malloc(sizeof(Saved_Level))) ==
+        (Saved_Level *)NULL)
+      died(DIED_MALLOC_FAILURE, 0);
   }
 
-  return -1; /* creation failure */
+  return saved_levels[lev];
 }
 
 /* =============================================================================
- * FUNCTION: eat
- */
-void eat(int xx, int yy) {
-  int dir;
-  int attempt;
-
+ * FUNCTION: use_level
+ *
+ * DESCRIPTION:
+ * Point the level arrays at the storage for a level.
+ *
+ * PARAMETERS:
+ *
+ *   lev : The dungeon level, or -1 for no current level (the empty level)
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+static void use_level(int lev) {
+  Saved_Level *storage;
+
+  if (lev < 0) {
+    memset(&no_level, 0, sizeof(no_level));
+    no_stolen.count = 0;
+    storage = &no_level;
+    stolen = &no_stolen;
+  } else {
+    storage = level_storage(lev);
+    stolen = &level_stolen[lev];
+  }
+
+  hitp = storage->hitp;
+  mitem = storage->mitem;
+  item = storage->item;
+  iarg = storage->iarg;
+  know = storage->know;
+  stolen_changes++;
+}
+
+/* =============================================================================
+ * FUNCTION: level_sum
+ *
+ * DESCRIPTION:
+ * Get the checksum of a stored level, including the items carried by the
+ * monsters on it.
+ *
+ * PARAMETERS:
+ *
+ *   lev     : The dungeon level
+ *
+ *   storage : The stored contents of the level
+ *
+ * RETURN VALUE:
+ *
+ *   The checksum.
+ */
+static unsigned int level_sum(int lev, Saved_Level *storage) {
+  Stolen_Table *Stolen = &level_stolen[lev];
+
+  return fastsum(storage, sizeof(Saved_Level)) ^
+         fastsum(Stolen->set, Stolen->count * (long)sizeof(StolenSet));
+}
+
+/* =============================================================================
+ * FUNCTION: check_level_sum
+ *
+ * DESCRIPTION:
+ * Check that a level hasn't changed since the player left it.
+ * The game ends if it has.
+ *
+ * PARAMETERS:
+ *
+ *   lev     : The dungeon level
+ *
+ *   storage : The stored contents of the level
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+static void check_level_sum(int lev, Saved_Level *storage) {
+  unsigned int i;
+
+  if (!level_sum_valid[lev])
+    return;
+
+  if ((i = level_sum(lev, storage)) != level_sums[lev]) {
+    Printf("\nOH NO!!!! INTERNAL MEMORY CORRUPTION!!!!\n");
+    Printf("(sum %u of level %d does not match saved sum %u)\n", i, lev,
+           level_sums[lev]);
+    UlarnBeep();
+    nap(5000);
+    died(DIED_INTERNAL_COMPLICATIONS, 0);
+  }
+}
+
+/* =============================================================================
+ * FUNCTION: same_word
+ *
+ * DESCRIPTION:
+ * Check if two words of a level being packed are the same.
+ *
+ * PARAMETERS:
+ *
+ *   a : The first word
+ *
+ *   b : The second word
+ *
+ * RETURN VALUE:
+ *
+ *   1 if the words are the same, otherwise 0.
+ */
+static int same_word(const unsigned char *a, const unsigned char *b) {
+  PackWord wa, wb;
+
+  memcpy(&wa, a, sizeof(wa));
+  memcpy(&wb, b, sizeof(wb));
+
+  return (wa == wb);
+}
+
+/* =============================================================================
+ * FUNCTION: pack_level
+ *
+ * DESCRIPTION:
+ * Replace the storage for a level with a packed copy.
+ *
+ * PARAMETERS:
+ *
+ *   lev : The dungeon level
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+static void pack_level(int lev) {
+  unsigned char data[PACK_LEN];
+  unsigned char *buf;
+  unsigned char tag;
+  long pos, n, tagpos;
+  int repeat;
+  int nz;
+  int i;
+
+  memset(data + sizeof(Saved_Level), 0, PACK_LEN - sizeof(Saved_Level));
+  memcpy(data, saved_levels[lev], sizeof(Saved_Level));
+
+  //
+  // At worst each word needs a tag byte and a repeat count
+  //
+  buf = (unsigned char *)malloc(PACK_LEN + 2 * (PACK_LEN / PACK_WORD));
+  if (buf == NULL)
+    died(DIED_MALLOC_FAILURE, 0);
+
+  n = 0;
+  pos = 0;
+
+  while (pos < PACK_LEN) {
+    tagpos = n++;
+
+    //
+    // Every byte is written, but the zero bytes are written over
+    //
+    tag = 0;
+    for (i = 0; i < PACK_WORD; i++) {
+      nz = (data[pos + i] != 0);
+      buf[n] = data[pos + i];
+      tag |= (unsigned char)(nz << i);
+      n += nz;
+    }
+
+    buf[tagpos] = tag;
+    pos += PACK_WORD;
+
+    if ((tag == 0) || (tag == PACK_ALL_SET)) {
+      repeat = 0;
+      while ((pos < PACK_LEN) && (repeat < PACK_MAX_REPEAT) &&
+             same_word(data + pos, data + pos - PACK_WORD)) {
+        repeat++;
+        pos += PACK_WORD;
+      }
+      buf[n++] = (unsigned char)repeat;
+    }
+  }
+
+  //
+  // Unpacking a word reads up to a word past its last byte, and the repeat
+  // count after it
+  //
+  packed_levels[lev] = (unsigned char *)malloc(n + PACK_WORD);
+  if (packed_levels[lev] == NULL)
+    died(DIED_MALLOC_FAILURE, 0);
+  memcpy(packed_levels[lev], buf, n);
+  memset(packed_levels[lev] + n, 0, PACK_WORD);
+  packed_sizes[lev] = n;
+
+  free(buf);
+
+  free(saved_levels[lev]);
+  saved_levels[lev] = NULL;
+}
+
+/* =============================================================================
+ * FUNCTION: unpack_level
+ *
+ * DESCRIPTION:
+ * Unpack the packed copy of a level.
+ *
+ * PARAMETERS:
+ *
+ *   lev     : The dungeon level
+ *
+ *   storage : The storage to unpack the level into
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+static void unpack_level(int lev, Saved_Level *storage) {
+  unsigned char data[PACK_LEN];
+  unsigned char *buf = packed_levels[lev];
+  unsigned char tag;
+  long pos, n;
+  int repeat;
+  int nz;
+  int i;
+
+  pos = 0;
+  n = 0;
+
+  while ((pos < PACK_LEN) && (n < packed_sizes[lev])) {
+    tag = buf[n++];
+
+    for (i = 0; i < PACK_WORD; i++) {
+      nz = (tag >> i) & 1;
+      data[pos + i] = (unsigned char)(buf[n] & -nz);
+      n += nz;
+    }
+    pos += PACK_WORD;
+
+    if ((tag == 0) || (tag == PACK_ALL_SET)) {
+      repeat = buf[n++];
+      if (pos + repeat * PACK_WORD > PACK_LEN)
+        break;
+      for (; repeat > 0; repeat--) {
+        memcpy(data + pos, data + pos - PACK_WORD, PACK_WORD);
+        pos += PACK_WORD;
+      }
+    }
+  }
+
+  if ((pos != PACK_LEN) || (n != packed_sizes[lev])) {
+    Printf("\nOH NO!!!! INTERNAL MEMORY CORRUPTION!!!!\n");
+    Printf("(packed level %d is damaged)\n", lev);
+    UlarnBeep();
+    nap(5000);
+    died(DIED_INTERNAL_COMPLICATIONS, 0);
+  }
+
+  memcpy(storage, data, sizeof(Saved_Level));
+}
+
+/* =============================================================================
+ * FUNCTION: discard_packed_level
+ *
+ * DESCRIPTION:
+ * Free the packed copy of a level, if it has one.
+ *
+ * PARAMETERS:
+ *
+ *   lev : The dungeon level
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+static void discard_packed_level(int lev) {
+  if (packed_levels[lev] != NULL) {
+    free(packed_levels[lev]);
+    packed_levels[lev] = NULL;
+    packed_sizes[lev] = 0;
+  }
+}
+
+/* =============================================================================
+ * FUNCTION: stored_level
+ *
+ * DESCRIPTION:
+ * Get the stored contents of a level that has been visited.
+ *
+ * PARAMETERS:
+ *
+ *   lev  : The dungeon level
+ *
+ *   temp : Storage for the level if it is packed
+ *
+ * RETURN VALUE:
+ *
+ *   The storage for the level, or temp with the level unpacked into it.
+ */
+static Saved_Level *stored_level(int lev, Saved_Level *temp) {
+  if (packed_levels[lev] == NULL)
+    return saved_levels[lev];
+
+  unpack_level(lev, temp);
+
+  return temp;
+}
+
+/* =============================================================================
+ * Exported functions
+ */
+
+/* =============================================================================
+ * FUNCTION: init_cells
+ */
+void init_cells(void) {
+  memset(level_sum_valid, 0, sizeof(level_sum_valid));
+  use_level(-1);
+}
+
+/* =============================================================================
+ * FUNCTION: free_cells
+ */
+void free_cells(void) {
+  int i;
+
+  for (i = 0; i < NLEVELS; i++) {
+    if (saved_levels[i] != (Saved_Level *)NULL) {
+      free(saved_levels[i]);
+      saved_levels[i] = NULL;
+    }
+    discard_packed_level(i);
+    stolen_free(&level_stolen[i]);
+  }
+
+  use_level(-1);
+}
+
+/* =============================================================================
+ * FUNCTION: level_storage_size
+ */
+long level_storage_size(void) {
+  long size;
+  int i;
+
+  size = 0;
+  for (i = 0; i < NLEVELS; i++) {
+    if (saved_levels[i] != (Saved_Level *)NULL)
+      size += (long)sizeof(Saved_Level);
+    size += packed_sizes[i];
+    size += level_stolen[i].size * (long)sizeof(StolenSet);
+  }
+
+  return size;
+}
+
+/* =============================================================================
+ * FUNCTION: cgood
+ */
+int cgood(int x, int y, int chkitm, int chkmonst) {
+  int good = 0;
+
+  if ((y >= 0) && (y <= MAXY - 1) && (x >= 0) &&
+      (x <= MAXX - 1)) { /* within bounds? */
+    if ((level == 1) && (x == 33) && (y == MAXY - 1))
+      /* exit to level 1 is never good */
+      return 0;
+
+    if ((item[x][y] == OWALL) || (item[x][y] == OCLOSEDDOOR))
+      /* can't make on walls or closed doors */
+      return 0;
+
+    /* Location is OK so far */
+    good = 1;
+
+    if (chkitm && (item[x][y] != ONOTHING))
+      /* checking items and it is not free of items */
+      good = 0;
+
+    if (chkmonst && (mitem[x][y].mon != MONST_NONE))
+      /* checking for monsters and not free of monsters */
+      good = 0;
+  }
+
+  return good;
+}
+
+/* =============================================================================
+ * FUNCTION: dropgold
+ */
+void dropgold(int amount) {
+  if (amount > 250)
+    createitem(playerx, playery, OMAXGOLD, (long)amount);
+  else
+    createitem(playerx, playery, OGOLDPILE, (long)amount);
+}
+
+/* =============================================================================
+ * FUNCTION: fillmonst
+ */
+int fillmonst(int what) {
+  int x, y;
+
+  if (!pick_empty_cell(&x, &y))
+    return -1; /* creation failure */
+
+  mitem[x][y].mon = (char)what;
+  roster_update(x, y);
+  stealth[x][y] = 0;
+  hitp[x][y] = monster[what].hitpoints;
+  return 0;
+}
+
+/* =============================================================================
+ * FUNCTION: eat
+ */
+void eat(int xx, int yy) {
+  int dir;
+  int attempt;
+
   dir = rnd(4);
   attempt = 2;
   while (attempt) {
@@ -1050,7 +1926,9 @@ void eat(int xx, int yy) {
       if ((item[xx - 1][yy] != OWALL) || (item[xx - 2][yy] != OWALL))
         break;
       item[xx - 1][yy] = ONOTHING;
+      item_update(xx - 1, yy);
       item[xx - 2][yy] = ONOTHING;
+      item_update(xx - 2, yy);
       eat(xx - 2, yy);
       break;
     case 2:
@@ -1059,7 +1937,9 @@ void eat(int xx, int yy) {
       if ((item[xx + 1][yy] != OWALL) || (item[xx + 2][yy] != OWALL))
         break;
       item[xx + 1][yy] = ONOTHING;
+      item_update(xx + 1, yy);
       item[xx + 2][yy] = ONOTHING;
+      item_update(xx + 2, yy);
       eat(xx + 2, yy);
       break;
     case 3:
@@ -1068,7 +1948,9 @@ void eat(int xx, int yy) {
       if ((item[xx][yy - 1] != OWALL) || (item[xx][yy - 2] != OWALL))
         break;
       item[xx][yy - 1] = ONOTHING;
+      item_update(xx, yy - 1);
       item[xx][yy - 2] = ONOTHING;
+      item_update(xx, yy - 2);
       eat(xx, yy - 2);
       break;
     case 4:
@@ -1077,7 +1959,9 @@ void eat(int xx, int yy) {
       if ((item[xx][yy + 1] != OWALL) || (item[xx][yy + 2] != OWALL))
         break;
       item[xx][yy + 1] = ONOTHING;
+      item_update(xx, yy + 1);
       item[xx][yy + 2] = ONOTHING;
+      item_update(xx, yy + 2);
       eat(xx, yy + 2);
       break;
     }
@@ -1093,42 +1977,29 @@ void eat(int xx, int yy) {
  * FUNCTION: savelevel
  */
 void savelevel(void) {
-  Saved_Level *storage = saved_levels[level];
-
-  memcpy((char *)storage->hitp, (char *)hitp, sizeof(Short_Ary));
-  memcpy((char *)storage->mitem, (char *)mitem, sizeof(Mitem_Ary));
-  memcpy((char *)storage->item, (char *)item, sizeof(Char_Ary));
-  memcpy((char *)storage->iarg, (char *)iarg, sizeof(Short_Ary));
-  memcpy((char *)storage->know, (char *)know, sizeof(Char_Ary));
-  level_sums[level] = sum((unsigned char *)storage, sizeof(Saved_Level));
+  level_sums[level] = level_sum(level, saved_levels[level]);
+  level_sum_valid[level] = 1;
+  level_times[level] = gtime;
 }
 
 /* =============================================================================
  * FUNCTION: getlevel
  */
 void getlevel(void) {
-  unsigned int i;
+  Saved_Level *storage;
 
-  Saved_Level *storage = saved_levels[level];
-
-  memcpy((char *)hitp, (char *)storage->hitp, sizeof(Short_Ary));
-  memcpy((char *)mitem, (char *)storage->mitem, sizeof(Mitem_Ary));
-  memcpy((char *)item, (char *)storage->item, sizeof(Char_Ary));
-  memcpy((char *)iarg, (char *)storage->iarg, sizeof(Short_Ary));
-  memcpy((char *)know, (char *)storage->know, sizeof(Char_Ary));
-
-  if (level_sums[level] > 0) {
-    if ((i = sum((unsigned char *)storage, sizeof(Saved_Level))) !=
-        level_sums[level]) {
-      Printf("\nOH NO!!!! INTERNAL MEMORY CORRUPTION!!!!\n");
-      Printf("(sum %u of level %d does not match saved sum %u)\n", i, level,
-             level_sums[level]);
-      UlarnBeep();
-      nap(5000);
-      died(DIED_INTERNAL_COMPLICATIONS, 0);
-    }
-  } else
-    level_sums[level] = sum((unsigned char *)storage, sizeof(Saved_Level));
+  if (packed_levels[level] != NULL) {
+    storage = level_storage(level);
+    unpack_level(level, storage);
+    discard_packed_level(level);
+  }
+
+  use_level(level);
+
+  /* the level is about to change, so its checksum is out of date */
+  level_sum_valid[level] = 0;
+
+  roster_rebuild();
 }
 
 /* =============================================================================
@@ -1189,8 +2060,12 @@ void AnalyseWalls(int x1, int y1, int x2, int y2) {
  */
 void newcavelevel(int x) {
   int i, j;
+  int oldlevel;
+  int stored;
 
-  if (beenhere[level]) {
+  oldlevel = level;
+  stored = beenhere[level];
+  if (stored) {
     savelevel(); /* put the level back into storage  */
   }
 
@@ -1210,6 +2085,9 @@ void newcavelevel(int x) {
   if (beenhere[x]) {
     /* get the new level and put in working storage */
     getlevel();
+    if (catchup)
+      /* the level has moved on while the player was away */
+      catchup_level(gtime - level_times[x]);
     /* spawn new monsters */
     sethp(0);
     /* remove any genocided monsters */
@@ -1219,19 +2097,28 @@ void newcavelevel(int x) {
     positionplayer();
   } else {
     /* never been here before, so don't know anything, and no monsters */
-    for (i = 0; i < MAXY; i++) {
-      for (j = 0; j < MAXX; j++) {
-        know[j][i] = OUNKNOWN;
-        mitem[j][i].mon = MONST_NONE;
+    discard_packed_level(x);
+    level_stolen[x].count = 0;
+    use_level(x);
+    memset(saved_levels[x], 0, sizeof(Saved_Level));
+    level_sum_valid[x] = 0;
+
+    for (i = 0; i < MAXX; i++) {
+      for (j = 0; j < MAXY; j++) {
+        know[i][j] = OUNKNOWN;
+        mitem[i][j].mon = MONST_NONE;
       }
     }
+    roster_rebuild();
 
     makemaze(x);
 
     /* if this is level 1 */
-    if (x == 1)
+    if (x == 1) {
       /* exit from dungeon */
       item[33][MAXY - 1] = ONOTHING;
+      item_update(33, MAXY - 1);
+    }
 
     AnalyseWalls(0, 0, MAXX - 1, MAXY - 1);
     makeobject(x);
@@ -1241,8 +2128,8 @@ void newcavelevel(int x) {
     sethp(1);
 
     if (wizard || x == 0) {
-      for (j = 0; j < MAXY; j++) {
-        for (i = 0; i < MAXX; i++) {
+      for (i = 0; i < MAXX; i++) {
+        for (j = 0; j < MAXY; j++) {
           know[i][j] = item[i][j];
           stealth[i][j] |= STEALTH_SEEN;
         }
@@ -1255,6 +2142,10 @@ void newcavelevel(int x) {
     /* Position the player on the map */
     positionplayer();
   }
+
+  /* the level arrays no longer point at the level the player left */
+  if (pack_levels && stored && (oldlevel != level))
+    pack_level(oldlevel);
 }
 
 /* =============================================================================
@@ -1316,6 +2207,7 @@ void createitem(int x, int y, int it, int arg) {
       if (cgood(ox, oy, 1, 0)) {
         /* if we can create an item here */
         item[ox][oy] = (char)it;
+        item_update(ox, oy);
         iarg[ox][oy] = (short)arg;
         return;
       }
@@ -1333,6 +2225,7 @@ void createitem(int x, int y, int it, int arg) {
           i = iarg[ox][oy];
           iarg[ox][oy] = (short)((10L * i + arg) / 10);
           item[ox][oy] = ODGOLD;
+          item_update(ox, oy);
           return;
         }
         /* fallthrough */
@@ -1341,6 +2234,7 @@ void createitem(int x, int y, int it, int arg) {
           i = (int)((100L * iarg[ox][oy]) + arg);
           iarg[ox][oy] = (short)(i / 100);
           item[ox][oy] = OMAXGOLD;
+          item_update(ox, oy);
           return;
         }
         /* fallthrough */
@@ -1349,6 +2243,7 @@ void createitem(int x, int y, int it, int arg) {
           i = iarg[ox][oy];
           iarg[ox][oy] = (short)((1000L * i + arg) / 1000);
           item[ox][oy] = OKGOLD;
+          item_update(ox, oy);
           return;
         } else
           iarg[ox][oy] = 32767;
@@ -1356,6 +2251,7 @@ void createitem(int x, int y, int it, int arg) {
       default:
         if (cgood(ox, oy, 1, 0)) {
           item[ox][oy] = (char)it;
+          item_update(ox, oy);
           if (it == OMAXGOLD)
             iarg[ox][oy] = (short)(arg / 100);
           else
@@ -1491,12 +2387,20 @@ int newobject(int lev, int *i) {
  */
 int write_levels(FILE *fp) {
   int i;
-  Saved_Level *storage;
+  Legacy_Level *Legacy;
+  Saved_Level *Temp;
+
+  Legacy = (Legacy_Level *)malloc(sizeof(Legacy_Level));
+  Temp = (Saved_Level *)malloc(sizeof(Saved_Level));
+  if ((Legacy == (Legacy_Level *)NULL) || (Temp == (Saved_Level *)NULL))
+    died(DIED_MALLOC_FAILURE, 0);
 
   /*
-   * Put the current level into storage
+   * Check the levels the player isn't on
    */
-  savelevel();
+  for (i = 0; i < NLEVELS; i++)
+    if (beenhere[i] && (i != level))
+      check_level_sum(i, stored_level(i, Temp));
 
   /*
    * save which level the player is currently on
@@ -1513,11 +2417,14 @@ int write_levels(FILE *fp) {
    */
   for (i = 0; i < NLEVELS; i++) {
     if (beenhere[i]) {
-      storage = saved_levels[i];
-      bwrite(fp, (char *)storage, sizeof(Saved_Level));
+      save_legacy_level(Legacy, stored_level(i, Temp), &level_stolen[i]);
+      bwrite(fp, (char *)Legacy, sizeof(Legacy_Level));
     }
   }
 
+  free(Legacy);
+  free(Temp);
+
   return 0;
 }
 
@@ -1526,7 +2433,7 @@ int write_levels(FILE *fp) {
  */
 int read_levels(FILE *fp) {
   int i;
-  Saved_Level *storage;
+  Legacy_Level *Legacy;
 
   /*
    * Read which level the player is currently on
@@ -1541,12 +2448,400 @@ int read_levels(FILE *fp) {
   /*
    * Read each of the visited levels
    */
+  Legacy = (Legacy_Level *)malloc(sizeof(Legacy_Level));
+  if (Legacy == (Legacy_Level *)NULL)
+    died(DIED_MALLOC_FAILURE, 0);
+
   for (i = 0; i < NLEVELS; i++) {
+    discard_packed_level(i);
+
     if (beenhere[i]) {
-      storage = saved_levels[i];
-      bread(fp, (char *)storage, sizeof(Saved_Level));
+      bread(fp, (char *)Legacy, sizeof(Legacy_Level));
+      load_legacy_level(level_storage(i), &level_stolen[i], Legacy);
+      level_sum_valid[i] = 0;
+
+      if (pack_levels && (i != level)) {
+        level_sums[i] = level_sum(i, saved_levels[i]);
+        level_sum_valid[i] = 1;
+        pack_level(i);
+      }
+    }
+
+    /* the save file doesn't hold when levels were stored */
+    level_times[i] = gtime;
+  }
+
+  free(Legacy);
+
+  return 0;
+}
+
+/* =============================================================================
+ * FUNCTION: digest_mitem
+ */
+DigestType digest_mitem(DigestType Digest, struct_mitem *Mitem,
+                        Stolen_Table *Stolen, int x) {
+  StolenSet *set;
+  int y;
+  int i;
+
+  for (y = 0; y < MAXY; y++) {
+    Digest = digest_bytes(Digest, &Mitem[y].mon, sizeof(Mitem[y].mon));
+
+    i = find_stolen(Stolen, x, y);
+    if (i < 0)
+      continue;
+
+    set = &Stolen->set[i];
+    Digest = digest_bytes(Digest, &set->n, sizeof(set->n));
+    for (i = 0; i < set->n; i++) {
+      Digest = digest_bytes(Digest, &set->it[i].item, sizeof(set->it[i].item));
+      Digest = digest_bytes(Digest, &set->it[i].itemarg,
+                            sizeof(set->it[i].itemarg));
+    }
+  }
+
+  return Digest;
+}
+
+/* =============================================================================
+ * FUNCTION: digest_levels
+ */
+DigestType digest_levels(DigestType Digest) {
+  Saved_Level *storage;
+  Saved_Level *Temp;
+  int i;
+
+  Temp = (Saved_Level *)malloc(sizeof(Saved_Level));
+  if (Temp == (Saved_Level *)NULL)
+    died(DIED_MALLOC_FAILURE, 0);
+
+  Digest = digest_bytes(Digest, beenhere, sizeof(beenhere));
+  Digest = digest_level(Digest, hitp, mitem, item, iarg, know, stolen);
+
+  //
+  // The current level has been added already, and levels not visited have
+  // never been written.
+  //
+  for (i = 0; i < NLEVELS; i++) {
+    if (beenhere[i] && (i != level)) {
+      storage = stored_level(i, Temp);
+      Digest = digest_level(Digest, storage->hitp, storage->mitem,
+                            storage->item, storage->iarg, storage->know,
+                            &level_stolen[i]);
+    }
+  }
+
+  free(Temp);
+
+  return Digest;
+}
+
+/* =============================================================================
+ * FUNCTION: roster_rebuild
+ */
+void roster_rebuild(void) {
+  int x, y;
+  int i;
+
+  /* drop the items carried by monsters that have gone */
+  for (i = stolen->count - 1; i >= 0; i--) {
+    x = stolen->set[i].x;
+    y = stolen->set[i].y;
+    if (mitem[x][y].mon == MONST_NONE)
+      stolen_remove(x, y);
+  }
+
+  roster_count = 0;
+
+  for (x = 0; x < MAXX; x++) {
+    monster_mask[x] = 0;
+
+    for (y = 0; y < MAXY; y++) {
+      if (mitem[x][y].mon != MONST_NONE) {
+        roster[roster_count].x = (char)x;
+        roster[roster_count].y = (char)y;
+        roster_count++;
+        RosterIndex[x][y] = (short)roster_count;
+        monster_mask[x] |= 1U << y;
+      } else
+        RosterIndex[x][y] = 0;
+    }
+  }
+
+  ScanActive = 0;
+  EmptyValid = 0;
+}
+
+/* =============================================================================
+ * FUNCTION: roster_update
+ */
+void roster_update(int x, int y) {
+  int i;
+  int key;
+  int lo, hi, mid;
+
+  update_empty(x, y);
+
+  i = RosterIndex[x][y];
+
+  if (mitem[x][y].mon != MONST_NONE) {
+    if (i != 0)
+      /* already in the roster */
+      return;
+
+    roster[roster_count].x = (char)x;
+    roster[roster_count].y = (char)y;
+    roster_count++;
+    RosterIndex[x][y] = (short)roster_count;
+    monster_mask[x] |= 1U << y;
+
+    if (!ScanActive || (x < ScanXl) || (x >= ScanXh) || (y < ScanYl) ||
+        (y >= ScanYh))
+      return;
+
+    key = y * MAXX + x;
+    if (key <= ScanLast)
+      /* the scan has already passed this location */
+      return;
+
+    /* find where this location goes in the scan, if it isn't there already */
+    lo = ScanHead;
+    hi = ScanTail;
+    while (lo < hi) {
+      mid = (lo + hi) / 2;
+      if (ScanList[mid] < key)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+    if ((lo < ScanTail) && (ScanList[lo] == key))
+      return;
+
+    memmove(&ScanList[lo + 1], &ScanList[lo],
+            (ScanTail - lo) * sizeof(ScanList[0]));
+    ScanList[lo] = (short)key;
+    ScanTail++;
+  } else {
+    /* the items carried by a monster that has gone go with it */
+    stolen_remove(x, y);
+
+    if (i != 0) {
+      /* move the last entry into the removed entry's place */
+      roster_count--;
+      roster[i - 1] = roster[roster_count];
+      RosterIndex[(int)roster[i - 1].x][(int)roster[i - 1].y] = (short)i;
+      RosterIndex[x][y] = 0;
+      monster_mask[x] &= ~(1U << y);
+    }
+  }
+}
+
+/* =============================================================================
+ * FUNCTION: roster_scan_start
+ */
+void roster_scan_start(int xl, int yl, int xh, int yh) {
+  int i, j;
+  int x, y;
+  short key;
+
+  ScanActive = 1;
+  ScanXl = xl;
+  ScanYl = yl;
+  ScanXh = xh;
+  ScanYh = yh;
+  ScanHead = 0;
+  ScanTail = 0;
+  ScanLast = -1;
+
+  /* insertion sort the monsters in the window into scan order */
+  for (i = 0; i < roster_count; i++) {
+    x = roster[i].x;
+    y = roster[i].y;
+
+    if ((x >= xl) && (x < xh) && (y >= yl) && (y < yh)) {
+      key = (short)(y * MAXX + x);
+
+      for (j = ScanTail; (j > 0) && (ScanList[j - 1] > key); j--)
+        ScanList[j] = ScanList[j - 1];
+      ScanList[j] = key;
+      ScanTail++;
     }
   }
+}
 
+/* =============================================================================
+ * FUNCTION: roster_scan_next
+ */
+int roster_scan_next(int *x, int *y) {
+  int key;
+
+  while (ScanActive && (ScanHead < ScanTail)) {
+    key = ScanList[ScanHead++];
+    ScanLast = key;
+
+    *x = key % MAXX;
+    *y = key / MAXX;
+
+    /* the monster may have gone since the scan started */
+    if (mitem[*x][*y].mon != MONST_NONE)
+      return 1;
+  }
+
+  ScanActive = 0;
   return 0;
 }
+
+/* =============================================================================
+ * FUNCTION: pick_empty_cell
+ */
+int pick_empty_cell(int *x, int *y) {
+  int count;
+  int player_entry;
+  int i;
+
+  if (!EmptyValid)
+    make_empty_index();
+
+  /* leave out the player's location */
+  count = EmptyCount;
+  player_entry = -1;
+  if ((playerx >= 0) && (playerx < MAXX) && (playery >= 0) && (playery < MAXY))
+    player_entry = EmptyIndex[playerx][playery] - 1;
+  if (player_entry >= 0)
+    count--;
+
+  if (count <= 0)
+    return 0;
+
+  i = rund(count);
+  if ((player_entry >= 0) && (i >= player_entry))
+    i++;
+
+  *x = EmptyList[i] % MAXX;
+  *y = EmptyList[i] / MAXX;
+
+  return 1;
+}
+
+/* =============================================================================
+ * FUNCTION: item_update
+ */
+void item_update(int x, int y) { update_empty(x, y); }
+
+/* =============================================================================
+ * FUNCTION: stolen_count
+ */
+int stolen_count(int x, int y) {
+  int i;
+
+  i = find_stolen(stolen, x, y);
+
+  return (i < 0) ? 0 : stolen->set[i].n;
+}
+
+/* =============================================================================
+ * FUNCTION: stolen_items
+ */
+StolenItem *stolen_items(int x, int y) {
+  int i;
+
+  i = find_stolen(stolen, x, y);
+
+  return (i < 0) ? NULL : stolen->set[i].it;
+}
+
+/* =============================================================================
+ * FUNCTION: stolen_full
+ */
+int stolen_full(int x, int y) {
+  int i;
+
+  i = find_stolen(stolen, x, y);
+
+  return (i >= 0) && (stolen->set[i].n >= MAX_STOLEN);
+}
+
+/* =============================================================================
+ * FUNCTION: stolen_add
+ */
+int stolen_add(int x, int y, int Item, int Arg) {
+  StolenSet *set;
+  int i;
+
+  if (stolen_full(x, y))
+    return 0;
+
+  i = find_stolen(stolen, x, y);
+  if (i < 0)
+    set = new_stolen_set(stolen, x, y);
+  else
+    set = &stolen->set[i];
+
+  set->it[(int)set->n].item = (char)Item;
+  set->it[(int)set->n].itemarg = (short)Arg;
+  set->n++;
+  stolen_changes++;
+
+  return 1;
+}
+
+/* =============================================================================
+ * FUNCTION: stolen_move
+ */
+void stolen_move(int sx, int sy, int dx, int dy) {
+  int i;
+
+  if (stolen->count == 0)
+    return;
+
+  stolen_remove(dx, dy);
+
+  i = find_stolen(stolen, sx, sy);
+  if (i >= 0) {
+    stolen->set[i].x = (char)dx;
+    stolen->set[i].y = (char)dy;
+    stolen_changes++;
+  }
+}
+
+/* =============================================================================
+ * FUNCTION: stolen_remove
+ */
+void stolen_remove(int x, int y) {
+  int i;
+
+  i = find_stolen(stolen, x, y);
+  if (i < 0)
+    return;
+
+  /* move the last entry into the gap */
+  stolen->count--;
+  stolen->set[i] = stolen->set[stolen->count];
+  stolen_changes++;
+}
+
+/* =============================================================================
+ * FUNCTION: stolen_copy
+ */
+void stolen_copy(Stolen_Table *To, Stolen_Table *From) {
+  int i;
+
+  To->count = 0;
+  for (i = 0; i < From->count; i++)
+    *new_stolen_set(To, 0, 0) = From->set[i];
+
+  if (To == stolen)
+    stolen_changes++;
+}
+
+/* =============================================================================
+ * FUNCTION: stolen_free
+ */
+void stolen_free(Stolen_Table *Stolen) {
+  free(Stolen->set);
+  Stolen->set = NULL;
+  Stolen->count = 0;
+  Stolen->size = 0;
+}
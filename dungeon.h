@@ -11,12 +11,16 @@
  *
  * item      : The item at each location on the current level
  * know      : What the player beleives is at each location
- * moved     : The monster moved status for each dungeon location
+ * moved     : The monster move pass for each dungeon location
  * stealth   : The monster stealth status for each dungeon location
  * hitp      : The monster hit points for each dungeon location
  * iarg      : The item arg for each dungeon location
- * screen    : Screen data used in moving monsters
- * mitem     : The monster and items it has stolen for each dungeon location
+ * mitem     : The monster at each dungeon location
+ * stolen    : The items carried by monsters on the current level
+ * stolen_changes : Counts changes to the items carried by monsters
+ * roster    : The locations of the monsters on the current level
+ * roster_count : The number of monsters on the current level
+ * monster_mask : The locations of the monsters in each column as bit masks
  * beenhere  : Which dungeon levels have been visited
  * level     : The current dungeon level
  * levelname : The name of each dungeon level
@@ -26,6 +30,7 @@
  *
  * init_cells     : Allocate dungeon storage
  * free_cells     : Free dungeon storage
+ * level_storage_size : Get the memory used by dungeon storage
  * cgood          : Check if a cell is empty (monster and/or item)
  * dropgold       : Drop gold around the player
  * fillmonst      : Attempt to put a monster into the dungeon
@@ -41,6 +46,22 @@
  * newobject      : Return a randomly selected item
  * write_levels   : Write dungeon levels to the save file
  * read_levels    : Read dungeon levels from the save file
+ * digest_mitem   : Add monsters and stolen items to a digest
+ * digest_levels  : Add the current and visited levels to a digest
+ * roster_rebuild : Make the monster roster from the current level
+ * roster_update  : Update the monster roster for a location
+ * roster_scan_start : Start a scan of the monsters in a window
+ * roster_scan_next  : Get the next monster location in a scan
+ * pick_empty_cell   : Pick a random empty location on the current level
+ * item_update       : Note that the item at a location has changed
+ * stolen_count : Get the number of items a monster is carrying
+ * stolen_items : Get the items a monster is carrying
+ * stolen_full  : Check if a monster can carry any more items
+ * stolen_add   : Give a monster an item to carry
+ * stolen_move  : Move the items a monster is carrying with the monster
+ * stolen_remove : Take away all the items a monster is carrying
+ * stolen_copy  : Copy a stolen item table
+ * stolen_free  : Free the entries of a stolen item table
  *
  * =============================================================================
  */
@@ -50,6 +71,9 @@
 
 # include <stdio.h>
 
+# include "config.h"
+# include "digest.h"
+
 # include "monster.h"
 
 /* =============================================================================
@@ -69,18 +93,41 @@
 # define MAXY 17
 
 /*
- * Items stolen by monsters data structure
+ * The monster at a location
+ */
+typedef struct {
+  char mon;
+} struct_mitem;
+
+/*
+ * Items stolen by monsters.
+ * Only a few monsters ever carry items, so the items are kept in a table of
+ * the locations of the monsters carrying them rather than at every location.
+ * A monster can carry up to MAX_STOLEN items. The table for each level grows
+ * as more monsters on it carry items.
+ * Anything that moves a monster must call stolen_move to move its items
+ * before calling roster_update for the location it left, as roster_update
+ * takes away the items at a location with no monster.
  */
+# define MAX_STOLEN 6
+
 typedef struct _s {
   char item;
   short itemarg;
 } StolenItem;
 
 typedef struct {
-  char mon;
+  char x;
+  char y;
   char n;
-  StolenItem it[6];
-} struct_mitem;
+  StolenItem it[MAX_STOLEN];
+} StolenSet;
+
+typedef struct {
+  int count;      /* the number of entries in use */
+  int size;       /* the number of entries allocated */
+  StolenSet *set;
+} Stolen_Table;
 
 /*
  * Stealth flags for monsters.
@@ -101,14 +148,48 @@ typedef struct {
 # define STEALTH_SEEN 1
 # define STEALTH_AWAKE 2
 
-extern char item[MAXX][MAXY];    /* objects in maze if any */
-extern char know[MAXX][MAXY];    /* contains what the player thinks is here */
-extern char moved[MAXX][MAXY];   /* monster movement flags  */
-extern char stealth[MAXX][MAXY]; /* 0=sleeping 1=awake monst    */
-extern short hitp[MAXX][MAXY];   /* monster hp on level  */
-extern short iarg[MAXX][MAXY];   /* arg for the item array */
-extern short screen[MAXX][MAXY]; /* The screen as the player knows it */
-extern struct_mitem mitem[MAXX][MAXY]; /* Items stolen by monstes array */
+/*
+ * The level arrays item, know, hitp, iarg and mitem and the stolen item table
+ * point into the storage for the current level, so they are used as
+ * item[x][y] etc. but sizeof gives the size of a pointer.
+ * They point at an empty level until the first level is entered.
+ */
+extern GAME_LOCAL char (*item)[MAXY];       /* objects in maze if any */
+extern GAME_LOCAL char (*know)[MAXY];       /* contains what the player thinks is here */
+extern GAME_LOCAL unsigned int moved[MAXX][MAXY]; /* monster move pass */
+extern GAME_LOCAL char stealth[MAXX][MAXY]; /* 0=sleeping 1=awake monst    */
+extern GAME_LOCAL short (*hitp)[MAXY];      /* monster hp on level  */
+extern GAME_LOCAL short (*iarg)[MAXY];      /* arg for the item array */
+extern GAME_LOCAL struct_mitem (*mitem)[MAXY]; /* monster on level */
+extern GAME_LOCAL Stolen_Table *stolen; /* items carried by monsters */
+extern GAME_LOCAL unsigned long stolen_changes; /* changes to stolen */
+
+/*
+ * The size of the level arrays item and know, which have the same type
+ */
+# define LEVEL_CHARS (MAXX * sizeof(*item))
+
+/*
+ * The roster of monsters on the current level.
+ * Every location on the current level with a monster has one entry in the
+ * roster, in no particular order, so passes over the monsters don't need to
+ * look at every location.
+ * Anything that puts a monster at a location or removes it must call
+ * roster_update for that location.
+ */
+typedef struct {
+  char x;
+  char y;
+} RosterEntry;
+
+extern GAME_LOCAL RosterEntry roster[MAXX * MAXY];
+extern GAME_LOCAL int roster_count;
+
+/*
+ * The monster occupancy of each column of the current level, with bit y set
+ * if there is a monster in row y. This is kept up to date with the roster.
+ */
+extern GAME_LOCAL unsigned int monster_mask[MAXX];
 
 /*
  * This serves two purposes:
@@ -122,9 +203,9 @@ extern struct_mitem mitem[MAXX][MAXY]; /* Items stolen by monstes array */
  *      When the monster that stole the items is killed, this is decremented
  *      for each item the monster drops.
  */
-extern char beenhere[NLEVELS];
+extern GAME_LOCAL char beenhere[NLEVELS];
 
-extern int level; /* cavelevel player is on = c[CAVELEVEL]*/
+extern GAME_LOCAL int level; /* cavelevel player is on = c[CAVELEVEL]*/
 
 extern char *levelname[]; /* Dungeon level names */
 
@@ -136,6 +217,7 @@ extern char *levelname[]; /* Dungeon level names */
 # define forget()                                                               \
   {                                                                            \
     item[playerx][playery] = ONOTHING;                                         \
+    item_update(playerx, playery);                                             \
     know[playerx][playery] = ONOTHING;                                         \
   }
 
@@ -147,6 +229,7 @@ extern char *levelname[]; /* Dungeon level names */
 # define disappear(x, y)                                                        \
   {                                                                            \
     mitem[x][y].mon = 0;                                                       \
+    roster_update(x, y);                                                       \
     if (know[x][y] != OUNKNOWN)                                                \
       show1cell(x, y);                                                         \
   }
@@ -168,7 +251,8 @@ extern char *levelname[]; /* Dungeon level names */
  * FUNCTION: init_cells
  *
  * DESCRIPTION:
- * Allocate storage for levels.
+ * Prepare the storage for levels.
+ * The storage for each level is allocated when the level is first entered.
  *
  * PARAMETERS:
  *
@@ -196,6 +280,23 @@ void init_cells(void);
  */
 void free_cells(void);
 
+/* =============================================================================
+ * FUNCTION: level_storage_size
+ *
+ * DESCRIPTION:
+ * Get the memory used by the storage for levels, including the current
+ * level and packed levels.
+ *
+ * PARAMETERS:
+ *
+ *   None.
+ *
+ * RETURN VALUE:
+ *
+ *   The number of bytes of level storage.
+ */
+long level_storage_size(void);
+
 /* =============================================================================
  * FUNCTION:
  *
@@ -278,6 +379,8 @@ void eat(int xx, int yy);
  *
  * DESCRIPTION:
  * Routine to save the present level into storage.
+ * The level arrays are already the storage for the level, so this only
+ * records the checksum of the level and when it was left.
  *
  * PARAMETERS:
  *
@@ -294,6 +397,8 @@ void savelevel(void);
  *
  * DESCRIPTION:
  * Routine to restore a level from storage.
+ * This points the level arrays at the storage for the level and makes the
+ * monster roster for it.
  *
  * PARAMETERS:
  *
@@ -457,6 +562,8 @@ int newobject(int lev, int *i);
  *
  * DESCRIPTION:
  * Write the dungeon levels to a save file
+ * The current level must have been put into storage with savelevel.
+ * The checksums of the levels the player isn't on are checked first.
  *
  * PARAMETERS:
  *
@@ -486,4 +593,335 @@ int write_levels(FILE *fp);
  */
 int read_levels(FILE *fp);
 
+/* =============================================================================
+ * FUNCTION: digest_mitem
+ *
+ * DESCRIPTION:
+ * Add the monsters in one column of a level and the items they carry to a
+ * digest.
+ * The items are added field by field so that structure padding does not
+ * affect the digest.
+ *
+ * PARAMETERS:
+ *
+ *   Digest : The digest so far.
+ *
+ *   Mitem  : The monsters in the column.
+ *
+ *   Stolen : The items carried by the monsters on the level.
+ *
+ *   x      : The column.
+ *
+ * RETURN VALUE:
+ *
+ *   The updated digest.
+ */
+DigestType digest_mitem(DigestType Digest, struct_mitem *Mitem,
+                        Stolen_Table *Stolen, int x);
+
+/* =============================================================================
+ * FUNCTION: digest_levels
+ *
+ * DESCRIPTION:
+ * Add the current level and the stored copies of the other levels visited
+ * to a digest.
+ *
+ * PARAMETERS:
+ *
+ *   Digest : The digest so far.
+ *
+ * RETURN VALUE:
+ *
+ *   The updated digest.
+ */
+DigestType digest_levels(DigestType Digest);
+
+/* =============================================================================
+ * FUNCTION: roster_rebuild
+ *
+ * DESCRIPTION:
+ * Make the monster roster from the monsters on the current level.
+ * This must be called whenever the whole level is replaced.
+ * The items carried by monsters that are no longer on the level are dropped
+ * from the stolen item table.
+ *
+ * PARAMETERS:
+ *
+ *   None.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+void roster_rebuild(void);
+
+/* =============================================================================
+ * FUNCTION: roster_update
+ *
+ * DESCRIPTION:
+ * Update the monster roster after a monster has been put at, or removed from,
+ * a location.
+ * If there is no monster at the location any more, the items it was carrying
+ * are taken away, so a monster being moved must have its items moved first
+ * with stolen_move.
+ *
+ * PARAMETERS:
+ *
+ *   x : The x coordinate of the location
+ *
+ *   y : The y coordinate of the location
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+void roster_update(int x, int y);
+
+/* =============================================================================
+ * FUNCTION: roster_scan_start
+ *
+ * DESCRIPTION:
+ * Start a scan of the monsters in a window of the current level.
+ * The scan visits the monster locations in the same order as looping over
+ * the rows of the window from top to bottom and each row from left to right.
+ * Monsters put in the window ahead of the scan while it is running are
+ * visited too, so the scan finds the same monsters as such a loop would.
+ *
+ * PARAMETERS:
+ *
+ *   xl : The leftmost x coordinate of the window
+ *
+ *   yl : The topmost y coordinate of the window
+ *
+ *   xh : One more than the rightmost x coordinate of the window
+ *
+ *   yh : One more than the bottommost y coordinate of the window
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+void roster_scan_start(int xl, int yl, int xh, int yh);
+
+/* =============================================================================
+ * FUNCTION: roster_scan_next
+ *
+ * DESCRIPTION:
+ * Get the location of the next monster in the current scan.
+ *
+ * PARAMETERS:
+ *
+ *   x : This is set to the x coordinate of the monster
+ *
+ *   y : This is set to the y coordinate of the monster
+ *
+ * RETURN VALUE:
+ *
+ *   1 if a monster was found
+ *   0 if there are no more monsters, which ends the scan
+ */
+int roster_scan_next(int *x, int *y);
+
+/* =============================================================================
+ * FUNCTION: pick_empty_cell
+ *
+ * DESCRIPTION:
+ * Pick a location uniformly at random from the empty locations on the
+ * current level, not counting the outer border. An empty location has no
+ * item, no monster and is not the player's location.
+ * This takes constant time: it uses an index of the empty locations that is
+ * kept up to date through roster_update and item_update.
+ *
+ * PARAMETERS:
+ *
+ *   x : This is set to the x coordinate of the location picked
+ *
+ *   y : This is set to the y coordinate of the location picked
+ *
+ * RETURN VALUE:
+ *
+ *   1 if a location was picked
+ *   0 if the level has no empty locations
+ */
+int pick_empty_cell(int *x, int *y);
+
+/* =============================================================================
+ * FUNCTION: item_update
+ *
+ * DESCRIPTION:
+ * Update the index of empty locations after the item at a location on the
+ * current level has been changed.
+ * Anything that changes the item at a location must call this for the
+ * location, unless the whole level is replaced, which calls roster_rebuild.
+ *
+ * PARAMETERS:
+ *
+ *   x : The x coordinate of the location
+ *
+ *   y : The y coordinate of the location
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+void item_update(int x, int y);
+
+/* =============================================================================
+ * FUNCTION: stolen_count
+ *
+ * DESCRIPTION:
+ * Get the number of items carried by the monster at a location on the
+ * current level.
+ *
+ * PARAMETERS:
+ *
+ *   x : The x coordinate of the monster
+ *
+ *   y : The y coordinate of the monster
+ *
+ * RETURN VALUE:
+ *
+ *   The number of items carried.
+ */
+int stolen_count(int x, int y);
+
+/* =============================================================================
+ * FUNCTION: stolen_items
+ *
+ * DESCRIPTION:
+ * Get the items carried by the monster at a location on the current level.
+ * The items are valid until the stolen items are next changed.
+ *
+ * PARAMETERS:
+ *
+ *   x : The x coordinate of the monster
+ *
+ *   y : The y coordinate of the monster
+ *
+ * RETURN VALUE:
+ *
+ *   A pointer to the stolen_count(x, y) items carried, or NULL if none.
+ */
+StolenItem *stolen_items(int x, int y);
+
+/* =============================================================================
+ * FUNCTION: stolen_full
+ *
+ * DESCRIPTION:
+ * Check if the monster at a location on the current level can carry any
+ * more items.
+ *
+ * PARAMETERS:
+ *
+ *   x : The x coordinate of the monster
+ *
+ *   y : The y coordinate of the monster
+ *
+ * RETURN VALUE:
+ *
+ *   1 if the monster can't carry any more items
+ *   0 if it can
+ */
+int stolen_full(int x, int y);
+
+/* =============================================================================
+ * FUNCTION: stolen_add
+ *
+ * DESCRIPTION:
+ * Give the monster at a location on the current level an item to carry.
+ *
+ * PARAMETERS:
+ *
+ *   x    : The x coordinate of the monster
+ *
+ *   y    : The y coordinate of the monster
+ *
+ *   Item : The item
+ *
+ *   Arg  : The item arg
+ *
+ * RETURN VALUE:
+ *
+ *   1 if the item was added
+ *   0 if the monster can't carry any more items
+ */
+int stolen_add(int x, int y, int Item, int Arg);
+
+/* =============================================================================
+ * FUNCTION: stolen_move
+ *
+ * DESCRIPTION:
+ * Move the items carried by a monster to its new location. Any items left at
+ * the new location are lost.
+ *
+ * PARAMETERS:
+ *
+ *   sx : The x coordinate the monster moved from
+ *
+ *   sy : The y coordinate the monster moved from
+ *
+ *   dx : The x coordinate the monster moved to
+ *
+ *   dy : The y coordinate the monster moved to
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+void stolen_move(int sx, int sy, int dx, int dy);
+
+/* =============================================================================
+ * FUNCTION: stolen_remove
+ *
+ * DESCRIPTION:
+ * Take away all the items carried by the monster at a location on the
+ * current level.
+ *
+ * PARAMETERS:
+ *
+ *   x : The x coordinate of the monster
+ *
+ *   y : The y coordinate of the monster
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+void stolen_remove(int x, int y);
+
+/* =============================================================================
+ * FUNCTION: stolen_copy
+ *
+ * DESCRIPTION:
+ * Copy a stolen item table, growing the destination if it is too small.
+ * Copying into the table for the current level counts as a change to it.
+ *
+ * PARAMETERS:
+ *
+ *   To   : The table to copy to
+ *
+ *   From : The table to copy from
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+void stolen_copy(Stolen_Table *To, Stolen_Table *From);
+
+/* =============================================================================
+ * FUNCTION: stolen_free
+ *
+ * DESCRIPTION:
+ * Free the entries of a stolen item table, leaving it empty.
+ *
+ * PARAMETERS:
+ *
+ *   Stolen : The stolen item table
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+void stolen_free(Stolen_Table *Stolen);
+
 #endif
@@ -246,6 +246,7 @@ void oopendoor(int x, int y) {
     iarg[x][y] = 0;
   } else {
     item[x][y] = OOPENDOOR;
+    item_update(x, y);
     show1cell(x, y);
   }
 }
@@ -403,9 +404,11 @@ void othrone(int arg) {
         creategem(); /*gems pop off the throne*/
       }
       item[playerx][playery] = ODEADTHRONE;
+      item_update(playerx, playery);
     } else if ((k < 40) && (arg == 0)) {
       createmonster(GNOMEKING);
       item[playerx][playery] = OTHRONE2;
+      item_update(playerx, playery);
     } else
       Print("\nNothing happens.");
     break;
@@ -416,6 +419,7 @@ void othrone(int arg) {
     if ((k < 30) && (arg == 0)) {
       createmonster(GNOMEKING);
       item[playerx][playery] = OTHRONE2;
+      item_update(playerx, playery);
     } else if (k < 35) {
       Print("\nZaaaappp!  You've been teleported!\n");
       UlarnBeep();
@@ -518,6 +522,7 @@ void ofountain(void) {
         Print("\nThe fountains bubbling slowly quietens.");
         /* dead fountain */
         item[playerx][playery] = ODEADFOUNTAIN;
+        item_update(playerx, playery);
       }
     }
     break;
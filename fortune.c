@@ -40,9 +40,9 @@ struct FortuneType {
   struct FortuneType *Next;
 };
 
-static struct FortuneType *fortunes = NULL;
-static int fortune_read = 0; /* true if we have loaded the fortune info */
-static int nlines = 0;       /* # lines in fortune database */
+static GAME_LOCAL struct FortuneType *fortunes = NULL;
+static GAME_LOCAL int fortune_read = 0; /* true if we have loaded the fortune info */
+static GAME_LOCAL int nlines = 0;       /* # lines in fortune database */
 
 /* =============================================================================
  * Exported functions
@@ -49,26 +49,18 @@
 #  include <io.h>
 # endif
 
+# include "rng.h"
+
 /*
  *  ------------------- macros --------------------
  */
 
-# ifdef DRAND48
-#  define srand srand48
-#  define rand lrand48
-# else
-#  ifdef RANDOM
-#   define srand srandom
-#   define rand random
-#  endif
-# endif /* RANDOM */
-
 // Generate a random number between 1 and x
-# define rnd(x) ((int)(rand() % (x)) + 1)
-# define rndl(x) ((long)(rand() % (x)) + 1)
+# define rnd(x) ((int)rng_below(x) + 1)
+# define rndl(x) ((long)rng_below(x) + 1)
 // Generate a random number between 0 and x-1
-# define rund(x) ((int)(rand() % (x)))
-# define rundl(x) ((long)(rand() % (x)))
+# define rund(x) ((int)rng_below(x))
+# define rundl(x) ((long)rng_below(x))
 
 /* macros for miscellaneous data conversion */
 # ifndef min
@@ -54,7 +54,7 @@ typedef enum { HELP_NORMAL, HELP_ESC, HELP_COUNT } HelpStateType;
 /*
  * A pointer to the help file handle.
  */
-static FILE *help_fp;
+static GAME_LOCAL FILE *help_fp;
 
 /* =============================================================================
  * Local functions
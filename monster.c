@@ -21,6 +21,7 @@
  * last_monst_hx : The x location of the last monster hit by the player
  * last_monst_hy : The y location of the last monster hit by the player
  * rmst          : The random monster creation countdown.
+ * roam_budget   : The most monsters outside the move window looked at per turn
  *
  * =============================================================================
  * EXPORTED FUNCTIONS
@@ -36,6 +37,7 @@
  * randmonst     : Create a random monster on the current cave level
  * teleportmonst : Teleport a monster
  * movemonst     : Move monsters.
+ * reset_move_policy : Make the monster movement policies again
  * parse2        : Function to call when player is not to move, but monsters are
  * write_monster_data : Function to write the monster data to the save file
  * read_monster_data  : Function to read the monster data from the save file
@@ -43,6 +45,8 @@
  * =============================================================================
  */
 
+#include <string.h>
+
 #include "monster.h"
 #include "dungeon.h"
 #include "header.h"
@@ -58,7 +62,7 @@
  * Exported variables
  */
 
-char monstnamelist[MONST_COUNT] = {
+GAME_LOCAL char monstnamelist[MONST_COUNT] = {
     ' ', 'l', 'G', 'H', 'J', 'K', 'O', 'S', 'c', 'j', 't', 'A', 'E', 'L',
     'N', 'Q', 'R', 'Z', 'a', 'b', 'h', 'i', 'C', 'T', 'Y', 'd', 'e', 'g',
     'm', 'v', 'z', 'F', 'W', 'f', 'l', 'o', 'r', 'X', 'V', ' ', 'p', 'q',
@@ -81,7 +85,7 @@ int monsttilelist[MONST_COUNT] = {
  */
 char monstlevel[] = {5, 11, 17, 22, 27, 33, 39, 42, 46, 50, 53, 56};
 
-struct monst monster[MONST_COUNT] = {
+GAME_LOCAL struct monst monster[MONST_COUNT] = {
 
    /* NAME                   LV   AC  DAM  ATT  INT   GOLD    HP     EXP  FLAGS
     *-----------------------------------------------------------------------------------------------------------------------------*/
@@ -152,12 +156,14 @@ struct monst monster[MONST_COUNT] = {
     {"demon prince",        19,  -90,  80,  6,  40,    0,  1000,  500000, FL_HEAD | FL_NOBEHEAD | FL_FLY | FL_INFRAVIS},
     {"God of Hellfire",     20, -120, 100,  6, 100,    0, 32767, 1000000, FL_HEAD | FL_NOBEHEAD | FL_FLY | FL_INFRAVIS}};
 
-char lastmonst[40]; /* name of the current monster */
-MonsterIdType last_monst_id =
+GAME_LOCAL char lastmonst[40]; /* name of the current monster */
+GAME_LOCAL MonsterIdType last_monst_id =
     MONST_NONE;    /* the last monster hitting the player */
-int last_monst_hx; /* x location of the last monster hit by player */
-int last_monst_hy; /* y location of the last monster hit by player */
-char rmst = 80;    /* Random monster creation timer */
+GAME_LOCAL int last_monst_hx; /* x location of the last monster hit by player */
+GAME_LOCAL int last_monst_hy; /* y location of the last monster hit by player */
+GAME_LOCAL char rmst = 80;    /* Random monster creation timer */
+
+int roam_budget = 0; /* monsters outside the move window looked at per turn */
 
 /* =============================================================================
  * Local variables
@@ -166,19 +172,132 @@ char rmst = 80;    /* Random monster creation timer */
 /*
  * Monster movement area for the current monster movement
  */
-static int move_xl, move_yl;
-static int move_xh, move_yh;
+static GAME_LOCAL int move_xl, move_yl;
+static GAME_LOCAL int move_xh, move_yh;
 
 /*
  * The maximum path distance for smart monster movement
  */
-static int distance;
+static GAME_LOCAL int distance;
+
+/*
+ * The number of the current movemonst pass.
+ * A monster has moved in this pass if its location in moved[][] is
+ * move_pass, so moved[][] doesn't need to be cleared for each pass.
+ */
+static GAME_LOCAL unsigned int move_pass = 0;
+
+/*
+ * Distance fields for smart monster path finding.
+ * Smart monsters that can pass through the same locations share one
+ * distance field from the player, which is made the first time a monster
+ * of that class moves in a movemonst pass.
+ */
+typedef enum {
+  PATH_GROUND,  /* walk, avoid all traps */
+  PATH_FLY,     /* fly over pits and trap doors */
+  PATH_VAMPIRE, /* fly, but avoid mirrors */
+  PATH_DEMON,   /* demon princes and above go through walls and traps */
+  PATH_CLASSES
+} PathClassType;
+
+/*
+ * The locations in each column of the level as a bit mask, with bit y set
+ * for row y.
+ */
+typedef unsigned int ColumnMask;
+
+#define ALL_ROWS ((ColumnMask)((1UL << MAXY) - 1))
+
+/*
+ * PathLayer[cls][d] holds the locations at distance d from the player in the
+ * distance field for path class cls. The player is at distance 1.
+ * PathDepth is the greatest distance in the field for each class, or 0 if
+ * there is no field for the class.
+ * Only columns PathXl to PathXh of the layers are set.
+ */
+#define MAX_PATH_DIST 40
+
+static GAME_LOCAL int PathDepth[PATH_CLASSES];
+static GAME_LOCAL int PathXl, PathXh;
+static GAME_LOCAL ColumnMask PathLayer[PATH_CLASSES][MAX_PATH_DIST + 1][MAXX];
+
+/*
+ * Occupancy layers for the region the distance fields can reach:
+ * walls and closed doors, the traps all smart monsters avoid, pits and
+ * trap doors, and mirrors.
+ */
+static GAME_LOCAL ColumnMask BlockLayer[MAXX];
+static GAME_LOCAL ColumnMask TrapLayer[MAXX];
+static GAME_LOCAL ColumnMask PitLayer[MAXX];
+static GAME_LOCAL ColumnMask MirrorLayer[MAXX];
+
+/*
+ * The player location and the item array when the distance fields were
+ * made. Monsters can change these during a pass (eg by teleporting the
+ * player or triggering traps), in which case the fields are made again.
+ */
+static GAME_LOCAL int PathFieldsValid = 0;
+static GAME_LOCAL int PathPlayerX, PathPlayerY;
+static GAME_LOCAL char PathItem[MAXX][MAXY];
+
+/*
+ * The fixed obstacles to dumb monster moves in each column of the level:
+ * walls, closed doors and mirrors. A column is read from the item array
+ * the first time a dumb monster looks at it in a movemonst pass, when
+ * MoveColumnPass for the column is set to move_pass.
+ * Monsters only change the item array by taking gold and gems during a
+ * pass, so the obstacles stay the same for the whole pass.
+ */
+static GAME_LOCAL ColumnMask WallColumn[MAXX];
+static GAME_LOCAL ColumnMask DoorColumn[MAXX];
+static GAME_LOCAL ColumnMask MirrorColumn[MAXX];
+static GAME_LOCAL unsigned int MoveColumnPass[MAXX];
+static GAME_LOCAL int MoveColumnLevel = -1;
+
+/*
+ * Monsters outside the move window roam every ROAM_INTERVAL turns.
+ * RoamCursor is the roster entry of the next monster to look at.
+ */
+#define ROAM_INTERVAL 2
+
+static GAME_LOCAL int RoamCursor = 0;
+
+/*
+ * The movement policy for each monster, made from the monster data and the
+ * difficulty so that moving a monster doesn't have to work it out again.
+ * The table is made again if the difficulty is not PolicyHardness.
+ */
+typedef struct {
+  char smart;    /* 1 if smart_move is used, 0 for dumb_move */
+  char slow;     /* 1 if the monster only moves every other turn */
+  char fearless; /* 1 if the monster is only scared by both the hand of */
+                 /* fear and scare monster */
+  char path;     /* The PathClassType for smart_move */
+} MovePolicy;
+
+static GAME_LOCAL MovePolicy MovePolicyTable[MONST_COUNT];
+static GAME_LOCAL long PolicyHardness = -1;
+
+/*
+ * What the player has to scare monsters: the hand of fear and/or the scare
+ * monster effect. This is worked out at the start of each movemonst pass
+ * and again after each monster attack, which could steal the hand of fear.
+ */
+typedef enum {
+  FEAR_NONE = 0,
+  FEAR_SCROLL = 1,
+  FEAR_HAND = 2,
+  FEAR_BOTH = 3
+} FearType;
+
+static GAME_LOCAL FearType Fear = FEAR_NONE;
 
 /*
  * The new location for the last monster moved
  * These will be set to -1 if the monster died.
  */
-static int movedx, movedy;
+static GAME_LOCAL int movedx, movedy;
 
 /*
  * Rustable armour data
@@ -635,6 +754,25 @@ static int spattack(int x, int xx, int yy) {
   return need_show;
 }
 
+/* =============================================================================
+ * FUNCTION: update_fear
+ *
+ * DESCRIPTION:
+ * Work out what the player has to scare monsters.
+ *
+ * PARAMETERS:
+ *
+ *   None.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+static void update_fear(void) {
+  Fear = (FearType)((player_has_item(OHANDofFEAR) ? FEAR_HAND : FEAR_NONE) |
+                    (c[SCAREMONST] ? FEAR_SCROLL : FEAR_NONE));
+}
+
 /* =============================================================================
  * FUNCTION:
  *
@@ -663,15 +801,14 @@ static void mmove(int sx, int sy, int dx, int dy) {
   int have_talisman;
   int trap_damage;
   int it;
-  int i;
-  int n;
   char *who;
   char *trap_msg;
 
   if ((dx == playerx) && (dy == playery)) {
     /* The destination is the player, so the monster attacks */
     hitplayer(sx, sy);
-    moved[sx][sy] = 1;
+    update_fear();
+    moved[sx][sy] = move_pass;
     movedx = sx;
     movedy = sy;
     return;
@@ -681,13 +818,7 @@ static void mmove(int sx, int sy, int dx, int dy) {
   it = item[dx][dy];
 
   /* Copy the monster and items it is carrying to the new location */
-  for (i = 0; i < mitem[sx][sy].n; i++) {
-    mitem[dx][dy].it[i].item = mitem[sx][sy].it[i].item;
-    mitem[dx][dy].it[i].itemarg = mitem[sx][sy].it[i].itemarg;
-    mitem[sx][sy].it[i].item = ONOTHING;
-    mitem[sx][sy].it[i].itemarg = 0;
-  }
-  mitem[dx][dy].n = mitem[sx][sy].n;
+  stolen_move(sx, sy, dx, dy);
   mitem[dx][dy].mon = mitem[sx][sy].mon;
 
   /* monsters that move are obviously awake */
@@ -696,17 +827,19 @@ static void mmove(int sx, int sy, int dx, int dy) {
 
   /* clear the monster from the old location */
   mitem[sx][sy].mon = MONST_NONE;
-  mitem[sx][sy].n = 0;
   hitp[sx][sy] = 0;
+  roster_update(dx, dy);
+  roster_update(sx, sy);
 
   /* mark this monster as moved */
-  moved[dx][dy] = 1;
+  moved[dx][dy] = move_pass;
 
   /* perform special processing for monsters */
 
   if (monst_id == LEMMING) {
     if (rnd(150) <= 1) {
       mitem[sx][sy].mon = LEMMING;
+      roster_update(sx, sy);
       hitp[sx][sy] = hitp[dx][dy];
     }
   }
@@ -722,13 +855,9 @@ static void mmove(int sx, int sy, int dx, int dy) {
     case ORUBY:
     case OEMERALD:
     case OSAPPHIRE:
-      if (mitem[dx][dy].n < 6) {
-        n = mitem[dx][dy].n;
-        mitem[dx][dy].it[n].item = item[dx][dy];
-        mitem[dx][dy].it[n].itemarg = iarg[dx][dy];
-        mitem[dx][dy].n++;
-      }
+      stolen_add(dx, dy, item[dx][dy], iarg[dx][dy]);
       item[dx][dy] = ONOTHING;
+      item_update(dx, dy);
       iarg[dx][dy] = 0;
       break;
 
@@ -764,16 +893,18 @@ static void mmove(int sx, int sy, int dx, int dy) {
         /* monster annihilated */
         trap_msg = "\nThe %s%s is destroyed by the sphere of annihilation!";
         mitem[dx][dy].mon = MONST_NONE;
-        mitem[dx][dy].n = 0;
+        stolen_remove(dx, dy);
         hitp[dx][dy] = 0;
+        roster_update(dx, dy);
         monst_killed = 1;
       }
     } else {
       /* monster annihilated */
       trap_msg = "\nThe %s%s is destroyed by the sphere of annihilation!";
       mitem[dx][dy].mon = MONST_NONE;
-      mitem[dx][dy].n = 0;
+      stolen_remove(dx, dy);
       hitp[dx][dy] = 0;
+      roster_update(dx, dy);
       monst_killed = 1;
     }
   } else if (it == OTRAPARROW) {
@@ -796,6 +927,7 @@ static void mmove(int sx, int sy, int dx, int dy) {
       trap_msg = "\nThe %s%s fell into a pit.";
       mitem[dx][dy].mon = MONST_NONE;
       hitp[dx][dy] = 0;
+      roster_update(dx, dy);
       monst_killed = 1;
     }
   } else if (it == OTRAPDOOR) {
@@ -804,6 +936,7 @@ static void mmove(int sx, int sy, int dx, int dy) {
       trap_msg = "\nThe %s%s fell through a trapdoor.";
       mitem[dx][dy].mon = MONST_NONE;
       hitp[dx][dy] = 0;
+      roster_update(dx, dy);
       monst_killed = 1;
     }
   } else if ((it == OELEVATORUP) || (it == OELEVATORDOWN)) {
@@ -812,6 +945,7 @@ static void mmove(int sx, int sy, int dx, int dy) {
       trap_msg = "\nThe %s%s is carried away by an elevator!";
       mitem[dx][dy].mon = MONST_NONE;
       hitp[dx][dy] = 0;
+      roster_update(dx, dy);
       monst_killed = 1;
     }
   }
@@ -823,6 +957,7 @@ static void mmove(int sx, int sy, int dx, int dy) {
     if (hitp[dx][dy] <= 0) {
       /* the trap killed the monster */
       mitem[dx][dy].mon = MONST_NONE;
+      roster_update(dx, dy);
       trap_msg = "\n%s hits and kills the %s.";
       monst_killed = 1;
     } else
@@ -925,35 +1060,77 @@ static int valid_monst_move(int x, int y, MonsterIdType monst_id) {
 }
 
 /* =============================================================================
- * FUNCTION: smart_move
+ * FUNCTION: reset_path_fields
  *
  * DESCRIPTION:
- * Function to move smart monsters.
+ * Discard the smart monster distance fields.
  *
  * PARAMETERS:
  *
- *   x : The x coordinate of the monster.
+ *   None.
  *
- *   y : The y coordinate of the monster.
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+static void reset_path_fields(void) {
+  memset(PathDepth, 0, sizeof(PathDepth));
+  PathFieldsValid = 0;
+}
+
+/* =============================================================================
+ * FUNCTION: path_class
+ *
+ * DESCRIPTION:
+ * Get the path class of a monster.
+ * Smart monsters of the same path class pass through the same locations.
+ *
+ * PARAMETERS:
+ *
+ *   monst : The monster id
+ *
+ * RETURN VALUE:
+ *
+ *   The path class for the monster.
+ */
+static PathClassType path_class(int monst) {
+  if (monst >= DEMONPRINCE)
+    return PATH_DEMON;
+  else if (monst == VAMPIRE)
+    return PATH_VAMPIRE;
+  else if ((monster[monst].flags & FL_FLY) != 0)
+    return PATH_FLY;
+  else
+    return PATH_GROUND;
+}
+
+/* =============================================================================
+ * FUNCTION: check_path_fields
+ *
+ * DESCRIPTION:
+ * Discard the distance fields if the player has moved or any location the
+ * fields could depend on has changed since they were made.
+ *
+ * PARAMETERS:
+ *
+ *   None.
  *
  * RETURN VALUE:
  *
  *   None.
  */
-static void smart_move(int x, int y) {
-  int sx, sy;
+static void check_path_fields(void) {
   int xl, yl;
   int xh, yh;
-  int xtmp, ytmp;
-  int path_dist;
-  int found_path;
-  MonsterIdType monst;
-  int on_map;
-  int z;
+  int x;
+  int changed;
 
-  monst = mitem[x][y].mon;
+  if (!PathFieldsValid)
+    return;
+
+  changed = (playerx != PathPlayerX) || (playery != PathPlayerY);
 
-  /* get the screen region to check for monster movement */
+  /* the fields can look one location beyond the region they spread over */
   xl = move_xl - 2;
   yl = move_yl - 2;
   xh = move_xh + 2;
@@ -961,128 +1138,361 @@ static void smart_move(int x, int y) {
   vxy(xl, yl);
   vxy(xh, yh);
 
-  for (sy = yl; sy <= yh; sy++) {
-    for (sx = xl; sx <= xh; sx++) {
-      if (valid_monst_move(sx, sy, monst)) {
-        if (monst >= DEMONPRINCE)
-          /* Monsters of rank DEMONPRICE and above ignore traps etc */
-          screen[sx][sy] = 0;
-        else {
-          /* smart monsters will avoid traps */
-          switch (item[sx][sy]) {
-          case OELEVATORUP:
-          case OELEVATORDOWN:
-          case OTRAPARROW:
-          case ODARTRAP:
-          case OTELEPORTER:
-            /* all monsters avoid there traps */
-            screen[sx][sy] = 127;
-            break;
-
-          case OPIT:
-          case OTRAPDOOR:
-            if ((monster[monst].flags & FL_FLY) != 0)
-              /* flying monsters ignore pits and trap doors. */
-              screen[sx][sy] = 0;
-            else
-              screen[sx][sy] = 127;
-            break;
-
-          default:
-            screen[sx][sy] = 0;
-            break;
-          }
-        }
-      } else
-        /* not valid for this monster to move here */
-        screen[sx][sy] = 127;
-      /* if valid move */
-    } /* for sx */
-  }   /* for sy */
-
-  /* Mark the player's location */
-  screen[playerx][playery] = 1;
-
-  /* now perform proximity ripple from playerx, playery to monster */
+  for (x = xl; (x <= xh) && !changed; x++)
+    changed = (memcmp(&item[x][yl], &PathItem[x][yl], yh - yl + 1) != 0);
+
+  if (changed)
+    reset_path_fields();
+}
+
+/* =============================================================================
+ * FUNCTION: make_item_layers
+ *
+ * DESCRIPTION:
+ * Make the occupancy layers for the region the distance fields can reach
+ * from the item array.
+ *
+ * PARAMETERS:
+ *
+ *   None.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+static void make_item_layers(void) {
+  ColumnMask bit;
+  int xl, yl;
+  int xh, yh;
+  int x, y;
+
+  memset(BlockLayer, 0, sizeof(BlockLayer));
+  memset(TrapLayer, 0, sizeof(TrapLayer));
+  memset(PitLayer, 0, sizeof(PitLayer));
+  memset(MirrorLayer, 0, sizeof(MirrorLayer));
+
+  xl = move_xl - 2;
+  yl = move_yl - 2;
+  xh = move_xh + 2;
+  yh = move_yh + 2;
+  vxy(xl, yl);
+  vxy(xh, yh);
+
+  for (x = xl; x <= xh; x++) {
+    for (y = yl; y <= yh; y++) {
+      bit = (ColumnMask)1 << y;
+
+      switch (item[x][y]) {
+      case OWALL:
+      case OCLOSEDDOOR:
+        BlockLayer[x] |= bit;
+        break;
+
+      case OELEVATORUP:
+      case OELEVATORDOWN:
+      case OTRAPARROW:
+      case ODARTRAP:
+      case OTELEPORTER:
+        TrapLayer[x] |= bit;
+        break;
+
+      case OPIT:
+      case OTRAPDOOR:
+        PitLayer[x] |= bit;
+        break;
+
+      case OMIRROR:
+        MirrorLayer[x] |= bit;
+        break;
+
+      default:
+        break;
+      }
+    }
+  }
+}
+
+/* =============================================================================
+ * FUNCTION: make_path_field
+ *
+ * DESCRIPTION:
+ * Make the distance field from the player for a path class.
+ * The field is flood filled a whole distance at a time: the locations at
+ * the next distance are the neighbours of the locations at this distance
+ * in the screen region round the movement window that the path class can
+ * pass through and that are not already in the field.
+ *
+ * PARAMETERS:
+ *
+ *   cls : The path class
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+static void make_path_field(PathClassType cls) {
+  ColumnMask passable[MAXX];
+  ColumnMask visited[MAXX];
+  ColumnMask grow[MAXX];
+  ColumnMask(*layer)[MAXX];
+  ColumnMask rows;
+  ColumnMask src;
+  ColumnMask any;
+  int xl, yl;
+  int xh, yh;
+  int gxl, gxh;
+  int depth;
+  int x;
+
+  if (!PathFieldsValid) {
+    /* remember what the fields are made from */
+    PathFieldsValid = 1;
+    PathPlayerX = playerx;
+    PathPlayerY = playery;
+    memcpy(PathItem, item, sizeof(PathItem));
+    make_item_layers();
+  }
+
+  /* get the screen region over which the path can spread */
   xl = move_xl - 1;
   yl = move_yl - 1;
   xh = move_xh + 1;
   yh = move_yh + 1;
   vxy(xl, yl);
   vxy(xh, yh);
+  rows = ALL_ROWS & ~(((ColumnMask)1 << yl) - 1) & (((ColumnMask)2 << yh) - 1);
+
+  /* the path can reach one column beyond the region */
+  gxl = (xl > 0) ? xl - 1 : 0;
+  gxh = (xh < MAXX - 1) ? xh + 1 : MAXX - 1;
+  PathXl = gxl;
+  PathXh = gxh;
+
+  for (x = gxl; x <= gxh; x++) {
+    switch (cls) {
+    case PATH_GROUND:
+      passable[x] = ~(BlockLayer[x] | TrapLayer[x] | PitLayer[x]);
+      break;
+    case PATH_FLY:
+      passable[x] = ~(BlockLayer[x] | TrapLayer[x]);
+      break;
+    case PATH_VAMPIRE:
+      passable[x] = ~(BlockLayer[x] | TrapLayer[x] | MirrorLayer[x]);
+      break;
+    default:
+      /* walls, doors and traps are no hindrance to a demon prince or above */
+      passable[x] = ALL_ROWS;
+      break;
+    }
+    visited[x] = 0;
+  }
+
+  if ((level == 1) && (gxl <= 33) && (gxh >= 33))
+    /* no monster can leave by the dungeon entrance */
+    passable[33] &= ~((ColumnMask)1 << (MAXY - 1));
 
-  path_dist = 1;
-  found_path = 0;
-
-  while ((path_dist < distance) && (!found_path)) {
-    for (sy = yl; sy <= yh; sy++) {
-      for (sx = xl; sx <= xh; sx++) {
-        if (screen[sx][sy] == path_dist) {
-          /*
-           * This square is path_dist steps from the player, so advance
-           * the path by one in all directions not already part of a path.
-           */
-          for (z = 1; z < 9; z++) {
-            xtmp = sx + diroffx[z];
-            ytmp = sy + diroffy[z];
-
-            if ((xtmp >= 0) && (xtmp < MAXX) && (ytmp >= 0) && (ytmp < MAXY)) {
-              /* This square is within the map */
-              if (screen[xtmp][ytmp] == 0) {
-                /*
-                 * a valid position that is not part of a path has been found,
-                 * so mark it as path_dist + 1 away from the player
-                 */
-                screen[xtmp][ytmp] = (char)(path_dist + 1);
-
-                if ((xtmp == x) && (ytmp == y))
-                  found_path = 1;
-              }
-            } /* if xtmp, ytmp on map */
-          }   /* for each direction */
-        }     /* if found path end */
-      }       /* for sx */
-    }         /* for sy */
-
-    path_dist++;
+  /* the path starts at the player's location */
+  layer = PathLayer[cls];
+  for (x = gxl; x <= gxh; x++)
+    layer[1][x] = 0;
+  layer[1][playerx] = (ColumnMask)1 << playery;
+  visited[playerx] = layer[1][playerx];
+
+  /*
+   * Locations at the maximum distance don't extend the path.
+   */
+  for (depth = 1; depth < distance; depth++) {
+    for (x = gxl; x <= gxh; x++)
+      grow[x] = 0;
+
+    /* spread the locations at this distance inside the region by one */
+    for (x = xl; x <= xh; x++) {
+      src = layer[depth][x] & rows;
+      if (src != 0) {
+        src |= (src << 1) | (src >> 1);
+        if (x > 0)
+          grow[x - 1] |= src;
+        grow[x] |= src;
+        if (x < MAXX - 1)
+          grow[x + 1] |= src;
+      }
+    }
+
+    any = 0;
+    for (x = gxl; x <= gxh; x++) {
+      layer[depth + 1][x] = grow[x] & ALL_ROWS & passable[x] & ~visited[x];
+      visited[x] |= layer[depth + 1][x];
+      any |= layer[depth + 1][x];
+    }
+
+    if (any == 0)
+      break;
   }
 
-  if (found_path) {
-    /* did find connectivity */
-    /*
-     * Now find the square with a distance 1 lower than the distance to the
-     * monster being moved.
-     */
-    path_dist = screen[x][y] - 1;
+  PathDepth[cls] = (depth < distance) ? depth : distance;
+}
 
-    for (z = 1; z < 9; z++) {
-      xl = x + diroffx[z];
-      yl = y + diroffy[z];
+/* =============================================================================
+ * FUNCTION: smart_move
+ *
+ * DESCRIPTION:
+ * Function to move smart monsters.
+ * The monster moves one step down the distance field from the player for
+ * its path class, making the field if this is the first monster of the
+ * class to move in this pass.
+ *
+ * PARAMETERS:
+ *
+ *   x : The x coordinate of the monster.
+ *
+ *   y : The y coordinate of the monster.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+static void smart_move(int x, int y) {
+  ColumnMask(*layer)[MAXX];
+  PathClassType cls;
+  int xl, yl;
+  int path_dist;
+  int on_map;
+  int z;
 
-      if (level == 0)
-        /*
-         * On the home level monsters can move right to the edge
-         * of the map
-         */
-        on_map = checkxy(xl, yl);
-      else
-        /*
-         * In the dungeon and volcano monsters can not move onto the
-         * outer border of walls.
-         */
-        on_map =
-            ((xl >= 1) && (xl < (MAXX - 1)) && (yl >= 1) && (yl < (MAXY - 1)));
-
-      if (on_map) {
-        if (screen[xl][yl] == path_dist) {
-          if (mitem[xl][yl].mon == MONST_NONE) {
-            mmove(x, y, xl, yl);
-            return;
-          }
-        }
+  cls = (PathClassType)MovePolicyTable[(int)mitem[x][y].mon].path;
+
+  check_path_fields();
+  if (PathDepth[cls] == 0)
+    make_path_field(cls);
+
+  if ((x < PathXl) || (x > PathXh))
+    /* no connectivity */
+    return;
+
+  /* find the monster's distance from the player */
+  layer = PathLayer[cls];
+  for (path_dist = 2; path_dist <= PathDepth[cls]; path_dist++)
+    if (((layer[path_dist][x] >> y) & 1) != 0)
+      break;
+
+  if (path_dist > PathDepth[cls])
+    /* no connectivity */
+    return;
+
+  /*
+   * Now find the square with a distance 1 lower than the distance to the
+   * monster being moved.
+   */
+  path_dist--;
+
+  for (z = 1; z < 9; z++) {
+    xl = x + diroffx[z];
+    yl = y + diroffy[z];
+
+    if (level == 0)
+      /*
+       * On the home level monsters can move right to the edge
+       * of the map
+       */
+      on_map = checkxy(xl, yl);
+    else
+      /*
+       * In the dungeon and volcano monsters can not move onto the
+       * outer border of walls.
+       */
+      on_map =
+          ((xl >= 1) && (xl < (MAXX - 1)) && (yl >= 1) && (yl < (MAXY - 1)));
+
+    if (on_map) {
+      if ((xl >= PathXl) && (xl <= PathXh) &&
+          (((layer[path_dist][xl] >> yl) & 1) != 0) &&
+          (mitem[xl][yl].mon == MONST_NONE)) {
+        mmove(x, y, xl, yl);
+        return;
+      }
+    }
+  }
+}
+
+/* =============================================================================
+ * FUNCTION: move_column_mask
+ *
+ * DESCRIPTION:
+ * Get the locations in a column that a monster could move to or attack,
+ * as valid_monst_move would decide for each location.
+ * Does NOT check if the locations are already occupied by another monster.
+ *
+ * PARAMETERS:
+ *
+ *   x        : The column
+ *
+ *   monst_id : The monster id
+ *
+ * RETURN VALUE:
+ *
+ *   The mask of locations in the column that the monster can occupy.
+ */
+static ColumnMask move_column_mask(int x, MonsterIdType monst_id) {
+  ColumnMask bit;
+  ColumnMask mask;
+  int y;
+
+  if (MoveColumnLevel != level) {
+    /* the columns read belong to another level */
+    memset(MoveColumnPass, 0, sizeof(MoveColumnPass));
+    MoveColumnLevel = level;
+  }
+
+  if (MoveColumnPass[x] != move_pass) {
+    WallColumn[x] = 0;
+    DoorColumn[x] = 0;
+    MirrorColumn[x] = 0;
+
+    for (y = 0; y < MAXY; y++) {
+      bit = (ColumnMask)1 << y;
+
+      switch (item[x][y]) {
+      case OWALL:
+        WallColumn[x] |= bit;
+        break;
+
+      case OCLOSEDDOOR:
+        DoorColumn[x] |= bit;
+        break;
+
+      case OMIRROR:
+        MirrorColumn[x] |= bit;
+        break;
+
+      default:
+        break;
       }
     }
+
+    MoveColumnPass[x] = move_pass;
+  }
+
+  if (monst_id >= DEMONPRINCE)
+    /* walls and closed doors are no hindrance to a demon prince or above */
+    mask = ALL_ROWS;
+  else {
+    /* a monster can hit a player who is walking through walls */
+    mask = WallColumn[x];
+    if (x == playerx)
+      mask &= ~((ColumnMask)1 << playery);
+
+    mask = ALL_ROWS & ~(mask | DoorColumn[x]);
   }
+
+  if (monst_id == VAMPIRE)
+    /* Vampires will not move onto mirrors */
+    mask &= ~MirrorColumn[x];
+
+  if ((level == 1) && (x == 33))
+    /* no monster can leave by the dungeon entrance */
+    mask &= ~((ColumnMask)1 << (MAXY - 1));
+
+  return mask;
 }
 
 /* =============================================================================
@@ -1103,12 +1513,14 @@ static void smart_move(int x, int y) {
  */
 static void dumb_move(int x, int y) {
   MonsterIdType monst_id;
-  short w1[9], w1x[9], w1y[9];
+  ColumnMask rows;
+  ColumnMask open;
   int xl, yl;
   int xh, yh;
   int tx, ty;
-  int j, k;
-  int tmp;
+  int bx, by;
+  int best;
+  int dist;
 
   monst_id = mitem[x][y].mon;
   xl = x - 1;
@@ -1135,33 +1547,39 @@ static void dumb_move(int x, int y) {
   if (yh > MAXY)
     yh = MAXY;
 
-  for (k = 0; k < 9; k++)
-    w1[k] = 10000;
+  rows = ALL_ROWS & ~(((ColumnMask)1 << yl) - 1) & (((ColumnMask)1 << yh) - 1);
 
-  /* For each square compute distance to player */
+  /*
+   * Find the closest free square to the player in the search area.
+   * The first closest square found wins, looking at each column in turn.
+   */
+  best = 10000;
+  bx = x;
+  by = y;
 
-  tmp = 0;
   for (tx = xl; tx < xh; tx++) {
+    open = rows & ~monster_mask[tx];
+    if (open != 0)
+      open &= move_column_mask(tx, monst_id);
+
+    if (open == 0)
+      continue;
+
     for (ty = yl; ty < yh; ty++) {
-      if (valid_monst_move(tx, ty, monst_id) &&
-          (mitem[tx][ty].mon == MONST_NONE)) {
-        w1[tmp] = (short)((playerx - tx) * (playerx - tx) +
-                          (playery - ty) * (playery - ty));
-        w1x[tmp] = (short)tx;
-        w1y[tmp] = (short)ty;
+      if ((open & ((ColumnMask)1 << ty)) == 0)
+        continue;
+
+      dist = (playerx - tx) * (playerx - tx) + (playery - ty) * (playery - ty);
+      if (dist < best) {
+        best = dist;
+        bx = tx;
+        by = ty;
       }
-      tmp++;
     }
   }
 
-  /* find the closest square in the search area */
-  j = 0;
-  for (k = 1; k < 9; k++)
-    if (w1[k] < w1[j])
-      j = k;
-
-  if ((w1[j] < 10000) && ((x != w1x[j]) || (y != w1y[j])))
-    mmove(x, y, w1x[j], w1y[j]);
+  if ((best < 10000) && ((x != bx) || (y != by)))
+    mmove(x, y, bx, by);
 }
 
 /* =============================================================================
@@ -1204,6 +1622,40 @@ static void scared_move(int x, int y) {
   return;
 }
 
+/* =============================================================================
+ * FUNCTION: make_move_policy
+ *
+ * DESCRIPTION:
+ * Make the movement policy table for the current difficulty, if it is not
+ * already made.
+ *
+ * PARAMETERS:
+ *
+ *   None.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+static void make_move_policy(void) {
+  MovePolicy *policy;
+  int monst;
+
+  if (PolicyHardness == c[HARDGAME])
+    return;
+
+  for (monst = 0; monst < MONST_COUNT; monst++) {
+    policy = &MovePolicyTable[monst];
+    policy->smart = (char)(monster[monst].intelligence > 10 - c[HARDGAME]);
+    policy->slow = (char)((monster[monst].flags & FL_SLOW) != 0);
+    policy->fearless =
+        (char)((monst > DEMONLORD) || (monst == PLATINUMDRAGON));
+    policy->path = (char)path_class(monst);
+  }
+
+  PolicyHardness = c[HARDGAME];
+}
+
 /* =============================================================================
  * FUNCTION: movemt
  *
@@ -1222,50 +1674,108 @@ static void scared_move(int x, int y) {
  *   None.
  */
 static void movemt(int x, int y) {
+  MovePolicy *policy;
   int Scared;
-  MonsterIdType monst;
 
-  monst = mitem[x][y].mon;
+  policy = &MovePolicyTable[(int)mitem[x][y].mon];
 
   /* half speed monsters only move every other turn */
-  if ((monster[monst].flags & FL_SLOW) != 0)
-    if ((gtime & 1) == 1)
-      return;
+  if (policy->slow && ((gtime & 1) == 1))
+    return;
 
-  /* choose destination randomly if scared */
+  /*
+   * Choose destination randomly if scared.
+   * The hand of fear alone is only effective 60% of the time, and is
+   * scarier (may work on higher level monsters) if scare monster is in
+   * effect. A demon lord or higher is only scared if the player has both
+   * the hand of fear and scare monster active, and even then only half the
+   * time.
+   */
+  switch (Fear) {
+  case FEAR_SCROLL:
+    Scared = !policy->fearless;
+    break;
 
-  /* Check for hand of fear */
-  Scared = player_has_item(OHANDofFEAR);
+  case FEAR_HAND:
+    Scared = (rnd(10) <= 4) && !policy->fearless;
+    break;
 
-  if (c[SCAREMONST])
-    /*
-     * hand of fear is scarier (may work on higher level monsters) if scare
-     * monster is in effect.
-     */
-    Scared++;
-  else if ((Scared == 1) && (rnd(10) > 4))
-    /*
-     * Hand of fear alone is only effective 60% of the time
-     */
-    Scared = 0;
+  case FEAR_BOTH:
+    Scared = policy->fearless ? (rnd(10) > 5) : 1;
+    break;
 
-  if ((monst > DEMONLORD) || (monst == PLATINUMDRAGON))
-    /*
-     * A demon lord or higher is only scared if the player has both
-     * the hand of fear and scare monster active.
-     * Even then, only half the time
-     */
-    Scared = (Scared <= 1) ? 0 : (rnd(10) > 5);
+  default:
+    Scared = 0;
+    break;
+  }
 
   /* Call the appropriate move routine */
   if (Scared)
     scared_move(x, y);
-  else if (monster[monst].intelligence > 10 - c[HARDGAME])
+  else if (policy->smart)
     smart_move(x, y);
   else
     dumb_move(x, y);
 }
 
+/* =============================================================================
+ * FUNCTION: roam_monsters
+ *
+ * DESCRIPTION:
+ * Move some of the awake monsters outside the move window.
+ * Looking at a monster is cheap and a dumb move doesn't depend on how many
+ * monsters there are, so the cost per turn is bounded by roam_budget.
+ *
+ * PARAMETERS:
+ *
+ *   None.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+static void roam_monsters(void) {
+  int visits;
+  int x, y;
+
+  if ((roam_budget <= 0) || ((gtime % ROAM_INTERVAL) != 0))
+    return;
+
+  visits = (roam_budget < roster_count) ? roam_budget : roster_count;
+
+  while (visits-- > 0) {
+    if (RoamCursor >= roster_count)
+      RoamCursor = 0;
+
+    /*
+     * A monster that moves keeps its roster entry, and a monster that dies
+     * has its entry taken by another monster, which is skipped this time.
+     */
+    x = roster[RoamCursor].x;
+    y = roster[RoamCursor].y;
+    RoamCursor++;
+
+    if ((x >= move_xl) && (x < move_xh) && (y >= move_yl) && (y < move_yh))
+      /* monsters in the window have already had their move */
+      continue;
+
+    if (moved[x][y] == move_pass)
+      /* the last monster hit by the player may be outside the window */
+      continue;
+
+    if (!c[AGGRAVATE] && ((stealth[x][y] & STEALTH_AWAKE) == 0))
+      /* sleeping monsters stay where they are */
+      continue;
+
+    if (MovePolicyTable[(int)mitem[x][y].mon].slow &&
+        (((gtime / ROAM_INTERVAL) & 1) != 0))
+      /* half speed monsters roam half as often */
+      continue;
+
+    dumb_move(x, y);
+  }
+}
+
 /* =============================================================================
  * Exported functions
  */
@@ -1297,6 +1807,7 @@ void createmonster(MonsterIdType mon) {
     /* if we can create a monster here */
     if (cgood(x, y, 0, 1)) {
       mitem[x][y].mon = (char)mon;
+      roster_update(x, y);
       hitp[x][y] = monster[mon].hitpoints;
       stealth[x][y] = 0; /* New monsters are not seen or awake */
 
@@ -1319,14 +1830,18 @@ void createmonster(MonsterIdType mon) {
  * FUNCTION: mon_has_item
  */
 int mon_has_item(int x, int y, int Item) {
+  StolenItem *it;
   int has_item;
+  int n;
   int i;
 
   has_item = 0;
 
   if (mitem[x][y].mon != 0) {
-    for (i = 0; i < mitem[x][y].n; i++)
-      if (mitem[x][y].it[i].item == Item)
+    it = stolen_items(x, y);
+    n = stolen_count(x, y);
+    for (i = 0; i < n; i++)
+      if (it[i].item == Item)
         has_item = 1;
   }
 
@@ -1532,22 +2047,28 @@ int hitm(int x, int y, int amt, int SpellFlag) {
 
   hpoints = hitp[x][y];
   if (hpoints <= amt) {
+    StolenItem it[MAX_STOLEN];
+    int n;
     int i;
 
+    /* the items it was carrying go when it disappears, so copy them first */
+    n = stolen_count(x, y);
+    if (n > 0)
+      memcpy(it, stolen_items(x, y), n * sizeof(StolenItem));
+
     Printf("\nThe %s died!", lastmonst);
     raiseexperience((long)monster[monst].experience);
     disappear(x, y);
 
-    if (mitem[x][y].n > 0) {
-      for (i = 0; i < mitem[x][y].n; i++) {
-        createitem(x, y, mitem[x][y].it[i].item, mitem[x][y].it[i].itemarg);
+    if (n > 0) {
+      for (i = 0; i < n; i++) {
+        createitem(x, y, it[i].item, it[i].itemarg);
       }
-      beenhere[level] -= mitem[x][y].n;
+      beenhere[level] -= n;
 
       if (beenhere[level] < 1)
         beenhere[level] = 1;
 
-      mitem[x][y].n = 0;
       if ((amt = monster[monst].gold) > 0)
         dropgold(rnd(amt) + amt);
     } else {
@@ -1739,39 +2260,26 @@ void randmonst(void) {
  * FUNCTION: teleportmonst
  */
 void teleportmonst(int xx, int yy, int monst) {
-  int i;
   int x, y;
-  int trys;
-
-  /* max # of teleport attempts */
-  for (trys = 10; trys > 0; --trys) {
-    x = rnd(MAXX - 2);
-    y = rnd(MAXY - 2);
-    if ((item[x][y] == ONOTHING) && (mitem[x][y].mon == MONST_NONE) &&
-        ((playerx != x) || (playery != y))) {
-      mitem[x][y].mon = (char)monst;
-      mitem[xx][yy].mon = MONST_NONE;
-
-      hitp[x][y] = monster[monst].hitpoints;
-      hitp[xx][yy] = 0;
-      for (i = 0; i < mitem[xx][yy].n; i++) {
-        mitem[x][y].it[i].item = mitem[xx][yy].it[i].item;
-        mitem[x][y].it[i].itemarg = mitem[xx][yy].it[i].itemarg;
-        mitem[xx][yy].it[i].item = ONOTHING;
-        mitem[xx][yy].it[i].itemarg = 0;
-      }
-      mitem[x][y].n = mitem[xx][yy].n;
-      mitem[xx][yy].n = 0;
 
-      /* store the new location */
-      movedx = x;
-      movedy = y;
+  if (!pick_empty_cell(&x, &y))
+    /* nowhere to go */
+    return;
 
-      show1cell(xx, yy);
+  stolen_move(xx, yy, x, y);
+  mitem[x][y].mon = (char)monst;
+  mitem[xx][yy].mon = MONST_NONE;
+  roster_update(x, y);
+  roster_update(xx, yy);
 
-      return;
-    }
-  }
+  hitp[x][y] = monster[monst].hitpoints;
+  hitp[xx][yy] = 0;
+
+  /* store the new location */
+  movedx = x;
+  movedy = y;
+
+  show1cell(xx, yy);
 }
 
 /* =============================================================================
@@ -1779,6 +2287,7 @@ void teleportmonst(int xx, int yy, int monst) {
  */
 void movemonst(void) {
   int i, j;
+  int awake_only;
 
   /* no action if time is stopped */
   if (c[TIMESTOP])
@@ -1802,7 +2311,7 @@ void movemonst(void) {
     move_yh = playery + 6;
     move_xl = playerx - 10;
     move_xh = playerx + 11;
-    distance = 40; /* depth of intelligent monster movement */
+    distance = MAX_PATH_DIST; /* depth of intelligent monster movement */
   } else {
     move_yl = playery - 3;
     move_yh = playery + 4;
@@ -1833,10 +2342,19 @@ void movemonst(void) {
       move_xh = MAXX - 1;
   }
 
-  /* now reset monster moved flags */
-  for (j = move_yl; j < move_yh; j++)
-    for (i = move_xl; i < move_xh; i++)
-      moved[i][j] = 0;
+  /* the player may have moved since the last pass */
+  reset_path_fields();
+
+  make_move_policy();
+  update_fear();
+
+  /* start a new pass, so no monsters have moved */
+  move_pass++;
+  if (move_pass == 0) {
+    memset(moved, 0, sizeof(moved));
+    memset(MoveColumnPass, 0, sizeof(MoveColumnPass));
+    move_pass = 1;
+  }
 
   /*
    * Move the last monster hit by the player
@@ -1856,30 +2374,30 @@ void movemonst(void) {
     }
   }
 
-  if (c[AGGRAVATE] || !c[STEALTH]) {
-    /* move monsters for aggravation or not stealthed */
-    for (j = move_yl; j < move_yh;
-         j++) { /* look thru all locations in window */
-      for (i = move_xl; i < move_xh; i++) {
-        if ((mitem[i][j].mon != MONST_NONE) && (moved[i][j] == 0))
-          /* if there is a monster to move and it isn't already moved */
-          movemt(i, j);
-      }
-    }
-  } else {
-    for (j = move_yl; j < move_yh; j++) {
-      for (i = move_xl; i < move_xh; i++) {
-        if ((mitem[i][j].mon != MONST_NONE) && (moved[i][j] == 0)) {
-          /* if there is a monster to move and it isn't already moved */
-          if ((stealth[i][j] & STEALTH_AWAKE) != 0)
-            /* Move awake monsters */
-            movemt(i, j);
-        }
-      }
+  /*
+   * Move all monsters in the window for aggravation or not stealthed,
+   * otherwise only move awake monsters.
+   */
+  awake_only = !c[AGGRAVATE] && c[STEALTH];
+
+  /* look thru all monsters in window */
+  roster_scan_start(move_xl, move_yl, move_xh, move_yh);
+  while (roster_scan_next(&i, &j)) {
+    if (moved[i][j] != move_pass) {
+      /* if the monster isn't already moved */
+      if (!awake_only || ((stealth[i][j] & STEALTH_AWAKE) != 0))
+        movemt(i, j);
     }
   }
+
+  roam_monsters();
 }
 
+/* =============================================================================
+ * FUNCTION: reset_move_policy
+ */
+void reset_move_policy(void) { PolicyHardness = -1; }
+
 /* =============================================================================
  * FUNCTION: parse2
  */
@@ -21,6 +21,7 @@
  * last_monst_hx : The x location of the last monster hit by the player
  * last_monst_hy : The y location of the last monster hit by the player
  * rmst          : The random monster creation countdown.
+ * roam_budget   : The most monsters outside the move window looked at per turn
  *
  * =============================================================================
  * EXPORTED FUNCTIONS
@@ -36,6 +37,7 @@
  * randmonst     : Create a random monster on the current cave level
  * teleportmonst : Teleport a monster
  * movemonst     : Move monsters.
+ * reset_move_policy : Make the monster movement policies again
  * parse2        : Function to call when player is not to move, but monsters are
  * write_monster_data : Function to write the monster data to the save file
  * read_monster_data  : Function to read the monster data from the save file
@@ -46,6 +48,7 @@
 #ifndef __MONSTER_H
 # define __MONSTER_H
 
+# include "config.h"
 # include "dungeon.h"
 
 # define MAXMONST 57 /* maximum # monsters in the dungeon  */
@@ -151,7 +154,7 @@ typedef enum {
 /*
  * Character codes to use for monsters
  */
-extern char monstnamelist[MONST_COUNT];
+extern GAME_LOCAL char monstnamelist[MONST_COUNT];
 
 /*
  * Tile numbers to use for monsters
@@ -161,20 +164,26 @@ extern int monsttilelist[MONST_COUNT];
 /*
  * The monster data
  */
-extern struct monst monster[MONST_COUNT];
+extern GAME_LOCAL struct monst monster[MONST_COUNT];
 
 /*
  * Name of the current monster
  */
-extern char lastmonst[40];
+extern GAME_LOCAL char lastmonst[40];
 
 /* number of the last monster hitting the player */
-extern MonsterIdType last_monst_id;
+extern GAME_LOCAL MonsterIdType last_monst_id;
 
-extern int last_monst_hx; /* x location of the last monster hit by player */
-extern int last_monst_hy; /* y location of the last monster hit by player */
+extern GAME_LOCAL int last_monst_hx; /* x location of the last monster hit by player */
+extern GAME_LOCAL int last_monst_hy; /* y location of the last monster hit by player */
 
-extern char rmst; /* Random monster creation timer */
+extern GAME_LOCAL char rmst; /* Random monster creation timer */
+
+/*
+ * The number of monsters outside the move window looked at for roaming each
+ * turn. 0 means monsters outside the move window never move.
+ */
+extern int roam_budget;
 
 /* =============================================================================
  * FUNCTION: createmonster
@@ -369,6 +378,10 @@ void teleportmonst(int xx, int yy, int monst);
  * DESCRIPTION:
  * This routine has the responsibility to determine which monsters are to
  * move, and to perform the movement.
+ * All monsters in a window round the player are moved. If roam_budget is
+ * set, some of the awake monsters outside the window roam as well: every
+ * other turn, the next roam_budget monsters in the roster are looked at, and
+ * those outside the window take a dumb step towards the player.
  *
  * PARAMETERS:
  *
@@ -380,6 +393,25 @@ void teleportmonst(int xx, int yy, int monst);
  */
 void movemonst(void);
 
+/* =============================================================================
+ * FUNCTION: reset_move_policy
+ *
+ * DESCRIPTION:
+ * The movement policy of each monster (smart or dumb, slow, scared by the
+ * hand of fear alone, how it finds a path) is worked out once and only made
+ * again when the difficulty changes. This forces it to be made again at the
+ * next movemonst, and must be called if the monster data is changed.
+ *
+ * PARAMETERS:
+ *
+ *   None.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+void reset_move_policy(void);
+
 /* =============================================================================
  * FUNCTION: parse2
  *
@@ -310,6 +310,7 @@ void ogold(int arg) {
 
   /* destroy gold */
   item[playerx][playery] = ONOTHING;
+  item_update(playerx, playery);
 }
 
 /* =============================================================================
@@ -340,8 +341,10 @@ void ochest(void) {
 
   case 't':
     Print(" take");
-    if (take(OCHEST, iarg[playerx][playery]) == 0)
+    if (take(OCHEST, iarg[playerx][playery]) == 0) {
       item[playerx][playery] = ONOTHING;
+      item_update(playerx, playery);
+    }
     break;
 
   case 'i':
@@ -457,6 +460,7 @@ void oopenchest(void) {
 
     /* Remove the chest */
     item[playerx][playery] = ONOTHING;
+    item_update(playerx, playery);
 
     /* create the items in the chest */
     if (rnd(100) < 69)
@@ -674,6 +678,7 @@ void lookforobject(void) {
     if (rnd(11) < 6)
       return;
     item[playerx][playery] = OTELEPORTER;
+    item_update(playerx, playery);
     /* fallthrough */
   case OTELEPORTER:
     /* fallthrough */
@@ -819,7 +824,9 @@ void lookforobject(void) {
 
       /* Make sure the entrance to the dungeon is clear */
       item[33][MAXY - 1] = ONOTHING;
+      item_update(33, MAXY - 1);
       mitem[33][MAXY - 1].mon = MONST_NONE;
+      roster_update(33, MAXY - 1);
 
       draws(0, MAXX, 0, MAXY);
       UpdateStatusAndEffects();
@@ -902,6 +909,7 @@ void lookforobject(void) {
     if (rnd(17) < 13)
       return; /* for an arrow trap */
     item[playerx][playery] = OTRAPARROW;
+    item_update(playerx, playery);
     /* fallthrough */
   case OTRAPARROW:
     Print("\nYou are hit by an arrow!");
@@ -915,6 +923,7 @@ void lookforobject(void) {
     if (rnd(17) < 13)
       return; /* for a dart trap */
     item[playerx][playery] = ODARTRAP;
+    item_update(playerx, playery);
     /* fallthrough */
   case ODARTRAP:
     Print("\nYou are hit by a dart!");
@@ -930,6 +939,7 @@ void lookforobject(void) {
     if (rnd(17) < 13)
       return; /* for a trap door */
     item[playerx][playery] = OTRAPDOOR;
+    item_update(playerx, playery);
     /* fallthrough */
   case OTRAPDOOR:
     for (i = 0; i < IVENSIZE; i++) {
@@ -172,36 +172,36 @@ long skill[] = {
  * Exported variables
  */
 
-char hitflag = 0;       /* flag for if player has been hit when running */
-char hit2flag = 0;      /* flag for if player has been hit when running */
-char hit3flag = 0;      /* flag for if player has been hit flush input*/
+GAME_LOCAL char hitflag = 0;       /* flag for if player has been hit when running */
+GAME_LOCAL char hit2flag = 0;      /* flag for if player has been hit when running */
+GAME_LOCAL char hit3flag = 0;      /* flag for if player has been hit flush input*/
 
-char char_class[20];    /* character class */
-int class_num;          /* character class number */
+GAME_LOCAL char char_class[20];    /* character class */
+GAME_LOCAL int class_num;          /* character class number */
 
-char ramboflag = 0;
-char sex = 1;                   /* default is man, 0=woman  */
-char wizard = 0;                /* the wizard mode flag */
-char cheat = 0;                 /* 1 if the player has fudged save file */
-char char_picked;               /* the character chosen */
-int playerx, playery;           /* the room on the present level of the player*/
-int lastpx, lastpy;             /* 0 --- MAXX-1  or  0 --- MAXY-1   */
+GAME_LOCAL char ramboflag = 0;
+GAME_LOCAL char sex = 1;                   /* default is man, 0=woman  */
+GAME_LOCAL char wizard = 0;                /* the wizard mode flag */
+GAME_LOCAL char cheat = 0;                 /* 1 if the player has fudged save file */
+GAME_LOCAL char char_picked;               /* the character chosen */
+GAME_LOCAL int playerx, playery;           /* the room on the present level of the player*/
+GAME_LOCAL int lastpx, lastpy;             /* 0 --- MAXX-1  or  0 --- MAXY-1   */
 
-time_t initialtime = 0;         /* time playing began   */
-long gtime = 0;                 /* the clock for the game */
-long outstanding_taxes = 0;     /* present tax bill from score file */
+GAME_LOCAL time_t initialtime = 0;         /* time playing began   */
+GAME_LOCAL long gtime = 0;                 /* the clock for the game */
+GAME_LOCAL long outstanding_taxes = 0;     /* present tax bill from score file */
 
-long c[ATTRIBUTE_COUNT];        /* Character description array */
-long cbak[ATTRIBUTE_COUNT];     /* Backup array for detecting changes */
+GAME_LOCAL long c[ATTRIBUTE_COUNT];        /* Character description array */
+GAME_LOCAL long cbak[ATTRIBUTE_COUNT];     /* Backup array for detecting changes */
 
-char iven[IVENSIZE];            /* inventory for player */
-short ivenarg[IVENSIZE];        /* inventory args for player  */
+GAME_LOCAL char iven[IVENSIZE];            /* inventory for player */
+GAME_LOCAL short ivenarg[IVENSIZE];        /* inventory args for player  */
 
-int potionknown[MAXPOTION];
+GAME_LOCAL int potionknown[MAXPOTION];
 
-int scrollknown[MAXSCROLL];
+GAME_LOCAL int scrollknown[MAXSCROLL];
 
-int spelknow[SPELL_COUNT];
+GAME_LOCAL int spelknow[SPELL_COUNT];
 
 /* =============================================================================
  * Local variables
@@ -212,7 +212,7 @@ int spelknow[SPELL_COUNT];
 /*
  * Haste step to keep track of frations of moves when hasted
  */
-static int HasteStep = 0;
+static GAME_LOCAL int HasteStep = 0;
 
 /*
  * Character fields affected by the passage of time
@@ -735,9 +735,9 @@ void raiseexperience(long x)
 		case 100:
 			Print("\nYou are now The Creator!");
 			{
-				int i, j;
+				int i;
 
-				for (i = 0; i < MAXY; i++) for (j = 0; j < MAXX; j++) know[j][i] = item[j][i];
+				memcpy(know, item, LEVEL_CHARS);
 				for (i = 0; i < SPELL_COUNT; i++) spelknow[i] = 1;
 				for (i = 0; i < MAXSCROLL; i++) scrollknown[i] = 1;
 				for (i = 0; i < MAXPOTION; i++) potionknown[i] = 1;
@@ -1184,6 +1184,7 @@ int drop_object(int k)
 
 	if (!pitflag) {
 		item[playerx][playery] = (char)itm;
+		item_update(playerx, playery);
 		iarg[playerx][playery] = (short)ivenarg[k];
 	}
 
@@ -1417,23 +1418,21 @@ int pocketfull(void)
  */
 int nearbymonst(void)
 {
-	int tx, ty;
-	int x1, y1;
-	int x2, y2;
+	int tx;
+	int x1, x2;
+	unsigned int rows;
 
 	x1 = playerx - 1;
 	x2 = playerx + 1;
-	y1 = playery - 1;
-	y2 = playery + 1;
 
 	if (x1 < 0) x1 = 0;
 	if (x2 >= MAXX) x2 = (MAXX - 1);
-	if (y1 < 0) y1 = 0;
-	if (y2 >= MAXY) y2 = (MAXY - 1);
+
+	/* the rows above, at and below the player */
+	rows = (7U << playery) >> 1;
 
 	for (tx = x1; tx <= x2; tx++)
-		for (ty = y1; ty <= y2; ty++)
-			if (mitem[tx][ty].mon != MONST_NONE) return 1; /* monster nearby */
+		if ((monster_mask[tx] & rows) != 0) return 1; /* monster nearby */
 
 	return 0;
 }
@@ -1445,8 +1444,8 @@ int stealsomething(int x, int y)
 {
 	int i, n = 100;
 
-	/* max of 6 stolen items per monster */
-	if (mitem[x][y].n >= 6)
+	/* max of MAX_STOLEN stolen items per monster */
+	if (stolen_full(x, y))
 		return 0;
 
 	while (n--) {
@@ -1455,9 +1454,7 @@ int stealsomething(int x, int y)
 			if (c[WEAR] != i && c[WIELD] != i && c[SHIELD] != i) {
 				show3(i);
 				adjustcvalues(iven[i], ivenarg[i]);
-				n = mitem[x][y].n++;
-				mitem[x][y].it[n].item = iven[i];
-				mitem[x][y].it[n].itemarg = ivenarg[i];
+				stolen_add(x, y, iven[i], ivenarg[i]);
 
 				iven[i] = ONOTHING;
 				ivenarg[i] = 0;
@@ -81,6 +81,7 @@
 #ifndef __PLAYER_H
 # define __PLAYER_H
 
+# include "config.h"
 # include "potion.h"
 # include "scroll.h"
 # include "spell.h"
@@ -214,26 +215,26 @@ typedef enum
  * Exported variables
  */
 
-extern char char_class[20];   /* character class */
-extern int  class_num;        /* Number to identify the character class */
+extern GAME_LOCAL char char_class[20];   /* character class */
+extern GAME_LOCAL int  class_num;        /* Number to identify the character class */
 
-extern char ramboflag;
-extern char sex;              /* default is man, 0=woman  */
-extern char wizard;           /* the wizard mode flag */
-extern char cheat;            /* 1 if the player has fudged save file */
-extern char char_picked;      /* the character chosen */
-extern int playerx, playery; /* the room on the present level of the player*/
-extern int lastpx, lastpy;   /* 0 --- MAXX-1  or  0 --- MAXY-1   */
+extern GAME_LOCAL char ramboflag;
+extern GAME_LOCAL char sex;              /* default is man, 0=woman  */
+extern GAME_LOCAL char wizard;           /* the wizard mode flag */
+extern GAME_LOCAL char cheat;            /* 1 if the player has fudged save file */
+extern GAME_LOCAL char char_picked;      /* the character chosen */
+extern GAME_LOCAL int playerx, playery; /* the room on the present level of the player*/
+extern GAME_LOCAL int lastpx, lastpy;   /* 0 --- MAXX-1  or  0 --- MAXY-1   */
 
-extern time_t initialtime;        /* time playing began   */
-extern long gtime;              /* the clock for the game */
-extern long outstanding_taxes;  /* present tax bill from score file */
+extern GAME_LOCAL time_t initialtime;        /* time playing began   */
+extern GAME_LOCAL long gtime;              /* the clock for the game */
+extern GAME_LOCAL long outstanding_taxes;  /* present tax bill from score file */
 
-extern long c[ATTRIBUTE_COUNT];    /* Character description array */
-extern long cbak[ATTRIBUTE_COUNT]; /* Backup array for detecting changes */
+extern GAME_LOCAL long c[ATTRIBUTE_COUNT];    /* Character description array */
+extern GAME_LOCAL long cbak[ATTRIBUTE_COUNT]; /* Backup array for detecting changes */
 
-extern char iven[IVENSIZE];     /* inventory for player */
-extern short ivenarg[IVENSIZE]; /* inventory args for player  */
+extern GAME_LOCAL char iven[IVENSIZE];     /* inventory for player */
+extern GAME_LOCAL short ivenarg[IVENSIZE]; /* inventory args for player  */
 
 extern char *class[];
 extern long skill[];
@@ -243,25 +244,25 @@ extern long skill[];
  *   0 = unknown
  *   1 = known
  */
-extern int potionknown[MAXPOTION];
+extern GAME_LOCAL int potionknown[MAXPOTION];
 
 /*
  * Array of which scrolls are known to the player.
  *   0 = unknown
  *   1 = known
  */
-extern int scrollknown[MAXSCROLL];
+extern GAME_LOCAL int scrollknown[MAXSCROLL];
 
 /*
  * Array of which spells are known to the player.
  *   0 = unknown
  *   1 = known
  */
-extern int spelknow[SPELL_COUNT];
+extern GAME_LOCAL int spelknow[SPELL_COUNT];
 
-extern char hitflag;
-extern char hit2flag;
-extern char hit3flag;
+extern GAME_LOCAL char hitflag;
+extern GAME_LOCAL char hit2flag;
+extern GAME_LOCAL char hit3flag;
 
 
 /* =============================================================================
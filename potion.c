@@ -186,8 +186,8 @@ void quaffpotion(int pot) {
     Print("\n  You feel greedy...");
     nap(2000);
 
-    for (i = 0; i < MAXY; i++) {
-      for (j = 0; j < MAXX; j++)
+    for (j = 0; j < MAXX; j++) {
+      for (i = 0; i < MAXY; i++)
         if ((item[j][i] == OGOLDPILE) || (item[j][i] == OMAXGOLD))
           show1cell(j, i);
     }
@@ -195,11 +195,8 @@ void quaffpotion(int pot) {
     return;
 
   case PMONSTDET:
-    for (i = 0; i < MAXY; i++) {
-      for (j = 0; j < MAXX; j++)
-        if (mitem[j][i].mon)
-          show1cell(j, i);
-    }
+    for (i = 0; i < roster_count; i++)
+      show1cell(roster[i].x, roster[i].y);
     return;
 
   case PFORGETFUL:
@@ -256,8 +253,8 @@ void quaffpotion(int pot) {
   case PTREASURE:
     Print("\n  You feel greedy...");
     nap(2000);
-    for (i = 0; i < MAXY; i++) {
-      for (j = 0; j < MAXX; j++) {
+    for (j = 0; j < MAXX; j++) {
+      for (i = 0; i < MAXY; i++) {
         k = item[j][i];
         if ((k == ODIAMOND) || (k == ORUBY) || (k == OEMERALD) ||
             (k == OMAXGOLD) || (k == OSAPPHIRE) || (k == OLARNEYE) ||
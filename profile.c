@@ -0,0 +1,440 @@
+/* =============================================================================
+ * PROGRAM:  ularn
+ * FILENAME: profile.c
+ *
+ * DESCRIPTION:
+ * Turn profiler.
+ * This module measures the time spent in each phase of a game turn using a
+ * monotonic clock, and records the time per turn for each phase in a
+ * histogram.
+ *
+ * =============================================================================
+ * EXPORTED VARIABLES
+ *
+ * None
+ *
+ * =============================================================================
+ * EXPORTED FUNCTIONS
+ *
+ * profile_enable : Start profiling
+ * profile_active : Check if profiling is enabled
+ * profile_begin  : Start timing a phase
+ * profile_end    : Stop timing a phase
+ * profile_turn   : Record the phase times for the turn just completed
+ * profile_show   : Show the profile summary on the screen
+ * profile_close  : Write the profile summary to stderr
+ *
+ * =============================================================================
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "config.h"
+#include "profile.h"
+#include "ularn_win.h"
+
+/* =============================================================================
+ * Local variables
+ */
+
+/*
+ * Phase names.
+ * The strings must match the order of the ProfilePhaseType enumeration,
+ * followed by the name for the whole turn.
+ */
+static char *PhaseName[PROFILE_COUNT + 1] = {
+    "lookforobject", "movemonst", "showcell", "parse",
+    "regen",         "spawn",     "turn"};
+
+/*
+ * The maximum depth of nested phases
+ */
+#define MAX_NESTING 8
+
+/*
+ * Histogram buckets.
+ * Each power of 2 nanoseconds is divided into 4 buckets, giving percentiles
+ * to within 25%. Times below 4 ns have a bucket each.
+ */
+#define SUB_BUCKETS 4
+#define MAX_OCTAVE 32
+#define NUM_BUCKETS (SUB_BUCKETS * MAX_OCTAVE)
+
+static GAME_LOCAL int Active = 0;
+
+/*
+ * The stack of phases being timed, and the clock time at which the phase on
+ * the top of the stack started or resumed.
+ */
+static GAME_LOCAL ProfilePhaseType PhaseStack[MAX_NESTING];
+static GAME_LOCAL int Depth = 0;
+static GAME_LOCAL double LastClock;
+
+/*
+ * The time spent in each phase in the current turn (ns)
+ */
+static GAME_LOCAL double TurnTime[PROFILE_COUNT];
+
+/*
+ * Per phase statistics, with the whole turn in the last entry
+ */
+static GAME_LOCAL long Turns = 0;
+static GAME_LOCAL long Histogram[PROFILE_COUNT + 1][NUM_BUCKETS];
+static GAME_LOCAL double TotalTime[PROFILE_COUNT + 1];
+static GAME_LOCAL double MaxTime[PROFILE_COUNT + 1];
+
+/* =============================================================================
+ * Local functions
+ */
+
+/* =============================================================================
+ * FUNCTION: profile_clock
+ *
+ * DESCRIPTION:
+ * Get a monotonic time in nanoseconds.
+ *
+ * PARAMETERS:
+ *
+ *   None.
+ *
+ * RETURN VALUE:
+ *
+ *   The current time in nanoseconds.
+ */
+static double profile_clock(void) {
+#ifdef UNIX
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (double)ts.tv_sec * 1.0e9 + (double)ts.tv_nsec;
+#else
+  return (double)clock() * (1.0e9 / (double)CLOCKS_PER_SEC);
+#endif
+}
+
+/* =============================================================================
+ * FUNCTION: bucket_of
+ *
+ * DESCRIPTION:
+ * Get the histogram bucket for a time.
+ *
+ * PARAMETERS:
+ *
+ *   Time : The time in nanoseconds
+ *
+ * RETURN VALUE:
+ *
+ *   The bucket index.
+ */
+static int bucket_of(double Time) {
+  unsigned long ns;
+  int octave;
+
+  if (Time < (double)SUB_BUCKETS)
+    return (Time < 0.0) ? 0 : (int)Time;
+
+  if (Time >= 4.0e9)
+    return NUM_BUCKETS - 1;
+
+  ns = (unsigned long)Time;
+
+  octave = 0;
+  while ((ns >> octave) >= 2 * SUB_BUCKETS)
+    octave++;
+
+  return SUB_BUCKETS * (octave + 1) + (int)((ns >> octave) - SUB_BUCKETS);
+}
+
+/* =============================================================================
+ * FUNCTION: bucket_limit
+ *
+ * DESCRIPTION:
+ * Get the upper limit of the times in a histogram bucket.
+ *
+ * PARAMETERS:
+ *
+ *   Bucket : The bucket index
+ *
+ * RETURN VALUE:
+ *
+ *   The first time in nanoseconds after the bucket.
+ */
+static double bucket_limit(int Bucket) {
+  int octave;
+
+  if (Bucket < SUB_BUCKETS)
+    return (double)(Bucket + 1);
+
+  octave = Bucket / SUB_BUCKETS - 1;
+
+  return (double)(SUB_BUCKETS + Bucket % SUB_BUCKETS + 1) *
+         (double)(1UL << octave);
+}
+
+/* =============================================================================
+ * FUNCTION: percentile
+ *
+ * DESCRIPTION:
+ * Get a percentile of the recorded times from the histogram.
+ *
+ * PARAMETERS:
+ *
+ *   Phase   : The phase, or PROFILE_COUNT for the whole turn
+ *
+ *   Percent : The percentile required
+ *
+ * RETURN VALUE:
+ *
+ *   The upper limit of the bucket containing the percentile, or the maximum
+ *   time if that is less.
+ */
+static double percentile(int Phase, double Percent) {
+  double target;
+  double limit;
+  long count;
+  int i;
+
+  target = (double)Turns * Percent / 100.0;
+  count = 0;
+
+  for (i = 0; i < NUM_BUCKETS; i++) {
+    count += Histogram[Phase][i];
+    if ((count > 0) && ((double)count >= target))
+      break;
+  }
+
+  limit = bucket_limit(i);
+
+  return (limit < MaxTime[Phase]) ? limit : MaxTime[Phase];
+}
+
+/* =============================================================================
+ * FUNCTION: out
+ *
+ * DESCRIPTION:
+ * Write a line of the summary to a file or the screen.
+ *
+ * PARAMETERS:
+ *
+ *   fp  : The file, or NULL for the screen
+ *
+ *   fmt : The printf style format
+ *
+ *   ... : The values to print
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+static void out(FILE *fp, char *fmt, ...) {
+  char buf[160];
+  va_list argptr;
+
+  va_start(argptr, fmt);
+  vsnprintf(buf, sizeof(buf), fmt, argptr);
+  va_end(argptr);
+
+  if (fp == NULL)
+    Print(buf);
+  else
+    fputs(buf, fp);
+}
+
+/* =============================================================================
+ * FUNCTION: write_summary
+ *
+ * DESCRIPTION:
+ * Write the percentile summary for each phase and the histogram of turn
+ * times.
+ *
+ * PARAMETERS:
+ *
+ *   fp : The file, or NULL for the screen
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+static void write_summary(FILE *fp) {
+  long count;
+  double low;
+  int phase;
+  int i, j;
+
+  out(fp, "Turn profile: %ld turns\n", Turns);
+  if (Turns == 0)
+    return;
+
+  out(fp, "%-14s %10s %10s %10s %10s %10s  (ns)\n", "phase", "mean", "p50",
+      "p90", "p99", "max");
+
+  for (phase = 0; phase <= PROFILE_COUNT; phase++) {
+    out(fp, "%-14s %10.0f %10.0f %10.0f %10.0f %10.0f\n", PhaseName[phase],
+        TotalTime[phase] / (double)Turns, percentile(phase, 50.0),
+        percentile(phase, 90.0), percentile(phase, 99.0), MaxTime[phase]);
+  }
+
+  //
+  // Histogram of turn times, one line per power of 2
+  //
+  out(fp, "\nTurn time histogram:\n");
+
+  low = 0.0;
+  for (i = 0; i < NUM_BUCKETS; i += SUB_BUCKETS) {
+    count = 0;
+    for (j = i; j < i + SUB_BUCKETS; j++)
+      count += Histogram[PROFILE_COUNT][j];
+
+    if (count != 0)
+      out(fp, "  %10.0f - %10.0f ns %10ld %5.1f%%\n", low,
+          bucket_limit(i + SUB_BUCKETS - 1), count,
+          100.0 * (double)count / (double)Turns);
+
+    low = bucket_limit(i + SUB_BUCKETS - 1);
+  }
+}
+
+/* =============================================================================
+ * FUNCTION: charge_phase
+ *
+ * DESCRIPTION:
+ * Add the time since the last clock reading to the phase being timed, if
+ * any, and take a new clock reading.
+ *
+ * PARAMETERS:
+ *
+ *   None.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+static void charge_phase(void) {
+  double now;
+
+  now = profile_clock();
+
+  if (Depth > 0)
+    TurnTime[PhaseStack[((Depth < MAX_NESTING) ? Depth : MAX_NESTING) - 1]] +=
+        now - LastClock;
+
+  LastClock = now;
+}
+
+/* =============================================================================
+ * Exported functions
+ */
+
+/* =============================================================================
+ * FUNCTION: profile_enable
+ */
+void profile_enable(void) {
+  if (Active)
+    return;
+
+  Active = 1;
+  Depth = 0;
+  Turns = 0;
+  memset(TurnTime, 0, sizeof(TurnTime));
+  memset(Histogram, 0, sizeof(Histogram));
+  memset(TotalTime, 0, sizeof(TotalTime));
+  memset(MaxTime, 0, sizeof(MaxTime));
+}
+
+/* =============================================================================
+ * FUNCTION: profile_active
+ */
+int profile_active(void) { return Active; }
+
+/* =============================================================================
+ * FUNCTION: profile_begin
+ */
+void profile_begin(ProfilePhaseType Phase) {
+  if (!Active)
+    return;
+
+  charge_phase();
+
+  //
+  // Phases nested too deeply are counted against the deepest phase recorded
+  //
+  if (Depth < MAX_NESTING)
+    PhaseStack[Depth] = Phase;
+  Depth++;
+}
+
+/* =============================================================================
+ * FUNCTION: profile_end
+ */
+void profile_end(void) {
+  if (!Active || (Depth == 0))
+    return;
+
+  charge_phase();
+  Depth--;
+}
+
+/* =============================================================================
+ * FUNCTION: profile_turn
+ */
+void profile_turn(void) {
+  double time;
+  double total;
+  int phase;
+
+  if (!Active)
+    return;
+
+  charge_phase();
+
+  total = 0.0;
+  for (phase = 0; phase <= PROFILE_COUNT; phase++) {
+    if (phase < PROFILE_COUNT) {
+      time = TurnTime[phase];
+      TurnTime[phase] = 0.0;
+      total += time;
+    } else
+      time = total;
+
+    Histogram[phase][bucket_of(time)]++;
+    TotalTime[phase] += time;
+    if (time > MaxTime[phase])
+      MaxTime[phase] = time;
+  }
+
+  Turns++;
+}
+
+/* =============================================================================
+ * FUNCTION: profile_show
+ */
+void profile_show(void) {
+  if (!Active) {
+    profile_enable();
+    Print("\nTurn profiling started.");
+    return;
+  }
+
+  set_display(DISPLAY_TEXT);
+  ClearText();
+
+  write_summary(NULL);
+
+  get_prompt_input("\nPress return to continue", "\015", 0);
+
+  set_display(DISPLAY_MAP);
+}
+
+/* =============================================================================
+ * FUNCTION: profile_close
+ */
+void profile_close(void) {
+  if (!Active)
+    return;
+
+  write_summary(stderr);
+}
@@ -0,0 +1,168 @@
+/* =============================================================================
+ * PROGRAM:  ularn
+ * FILENAME: profile.h
+ *
+ * DESCRIPTION:
+ * Turn profiler.
+ * This module measures the time spent in each phase of a game turn using a
+ * monotonic clock, and records the time per turn for each phase in a
+ * histogram. Phases may be nested, in which case the time is counted against
+ * the innermost phase only, so the phase times of a turn add up to the time
+ * spent in the game logic for that turn. The time waiting for the next
+ * command is not counted, but prompts answered within a phase are.
+ *
+ * Profiling is enabled by the -P command line option, or by the wizard
+ * profile command. The summary is written to stderr at the end of the game.
+ *
+ * =============================================================================
+ * EXPORTED VARIABLES
+ *
+ * None
+ *
+ * =============================================================================
+ * EXPORTED FUNCTIONS
+ *
+ * profile_enable : Start profiling
+ * profile_active : Check if profiling is enabled
+ * profile_begin  : Start timing a phase
+ * profile_end    : Stop timing a phase
+ * profile_turn   : Record the phase times for the turn just completed
+ * profile_show   : Show the profile summary on the screen
+ * profile_close  : Write the profile summary to stderr
+ *
+ * =============================================================================
+ */
+
+#ifndef __PROFILE_H
+# define __PROFILE_H
+
+/*
+ * The phases of a turn
+ */
+typedef enum {
+  PROFILE_LOOKFOROBJECT, /* Looking for objects under the player */
+  PROFILE_MOVEMONST,     /* Moving monsters and spheres */
+  PROFILE_SHOWCELL,      /* Updating the player's view */
+  PROFILE_PARSE,         /* Executing the player's command */
+  PROFILE_REGEN,         /* Regenerating the player */
+  PROFILE_SPAWN,         /* Creating random monsters */
+  PROFILE_COUNT
+} ProfilePhaseType;
+
+/* =============================================================================
+ * FUNCTION: profile_enable
+ *
+ * DESCRIPTION:
+ * Start profiling turns for the current game.
+ *
+ * PARAMETERS:
+ *
+ *   None.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+void profile_enable(void);
+
+/* =============================================================================
+ * FUNCTION: profile_active
+ *
+ * DESCRIPTION:
+ * Check if turn profiling is enabled.
+ *
+ * PARAMETERS:
+ *
+ *   None.
+ *
+ * RETURN VALUE:
+ *
+ *   1 if profiling is enabled, otherwise 0.
+ */
+int profile_active(void);
+
+/* =============================================================================
+ * FUNCTION: profile_begin
+ *
+ * DESCRIPTION:
+ * Start timing a phase.
+ * Timing of any enclosing phase is suspended until this phase ends.
+ *
+ * PARAMETERS:
+ *
+ *   Phase : The phase starting.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+void profile_begin(ProfilePhaseType Phase);
+
+/* =============================================================================
+ * FUNCTION: profile_end
+ *
+ * DESCRIPTION:
+ * Stop timing the most recently started phase and resume timing of any
+ * enclosing phase.
+ *
+ * PARAMETERS:
+ *
+ *   None.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+void profile_end(void);
+
+/* =============================================================================
+ * FUNCTION: profile_turn
+ *
+ * DESCRIPTION:
+ * Record the phase times for the turn just completed and start timing a new
+ * turn. Phases still being timed continue into the new turn.
+ *
+ * PARAMETERS:
+ *
+ *   None.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+void profile_turn(void);
+
+/* =============================================================================
+ * FUNCTION: profile_show
+ *
+ * DESCRIPTION:
+ * Show the profile summary on the screen.
+ * If profiling is not enabled then it is started instead.
+ *
+ * PARAMETERS:
+ *
+ *   None.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+void profile_show(void);
+
+/* =============================================================================
+ * FUNCTION: profile_close
+ *
+ * DESCRIPTION:
+ * Write the profile summary to stderr, if profiling is enabled.
+ *
+ * PARAMETERS:
+ *
+ *   None.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+void profile_close(void);
+
+#endif
@@ -0,0 +1,163 @@
+/* =============================================================================
+ * PROGRAM:  ularn
+ * FILENAME: rng.c
+ *
+ * DESCRIPTION:
+ * This module contains the random number generator for the game.
+ * The generator is xoshiro128** with explicit state, so that games can be
+ * reproduced from a seed and the generator state can be saved with the game.
+ * Random numbers in a range are drawn without modulo bias.
+ *
+ * =============================================================================
+ * EXPORTED VARIABLES
+ *
+ * None
+ *
+ * =============================================================================
+ * EXPORTED FUNCTIONS
+ *
+ * rng_seed  : Seed the random number generator
+ * rng_next  : Get the next 32 bit random number
+ * rng_below : Get a random number in the range 0 to n-1
+ * write_rng : Write the random number generator state to the save file
+ * read_rng  : Read the random number generator state from the save file
+ *
+ * =============================================================================
+ */
+
+#include "config.h"
+#include "rng.h"
+#include "saveutils.h"
+
+/* =============================================================================
+ * Local variables
+ */
+
+/*
+ * The generator works on 32 bit words.
+ * unsigned long is at least 32 bits everywhere, so all arithmetic is masked.
+ */
+#define RNG_MASK 0xffffffffUL
+
+#define ROTL32(x, k) ((((x) << (k)) | ((x) >> (32 - (k)))) & RNG_MASK)
+
+/*
+ * The generator state.
+ * This must never be all zero.
+ */
+static GAME_LOCAL unsigned long rng_state[4] = {0x9e3779b9UL, 0x243f6a88UL, 0xb7e15162UL,
+                                     0x6a09e667UL};
+
+/* =============================================================================
+ * Local functions
+ */
+
+/* =============================================================================
+ * FUNCTION: rng_mix
+ *
+ * DESCRIPTION:
+ * Hash a 32 bit value to spread the seed bits over the generator state.
+ *
+ * PARAMETERS:
+ *
+ *   x : The value to hash.
+ *
+ * RETURN VALUE:
+ *
+ *   The hashed value.
+ */
+static unsigned long rng_mix(unsigned long x) {
+  x &= RNG_MASK;
+  x ^= x >> 16;
+  x = (x * 0x7feb352dUL) & RNG_MASK;
+  x ^= x >> 15;
+  x = (x * 0x846ca68bUL) & RNG_MASK;
+  x ^= x >> 16;
+
+  return x;
+}
+
+/* =============================================================================
+ * Exported functions
+ */
+
+/* =============================================================================
+ * FUNCTION: rng_seed
+ */
+void rng_seed(unsigned long seed) {
+  int i;
+
+  for (i = 0; i < 4; i++)
+    rng_state[i] = rng_mix(seed + (unsigned long)(i + 1) * 0x9e3779b9UL);
+
+  if ((rng_state[0] | rng_state[1] | rng_state[2] | rng_state[3]) == 0)
+    rng_state[0] = 1;
+}
+
+/* =============================================================================
+ * FUNCTION: rng_next
+ */
+unsigned long rng_next(void) {
+  unsigned long result;
+  unsigned long t;
+
+  result = (rng_state[1] * 5) & RNG_MASK;
+  result = (ROTL32(result, 7) * 9) & RNG_MASK;
+
+  t = (rng_state[1] << 9) & RNG_MASK;
+
+  rng_state[2] ^= rng_state[0];
+  rng_state[3] ^= rng_state[1];
+  rng_state[1] ^= rng_state[2];
+  rng_state[0] ^= rng_state[3];
+
+  rng_state[2] ^= t;
+  rng_state[3] = ROTL32(rng_state[3], 11);
+
+  return result;
+}
+
+/* =============================================================================
+ * FUNCTION: rng_below
+ */
+long rng_below(long n) {
+  unsigned long range;
+  unsigned long limit;
+  unsigned long r;
+
+  range = (unsigned long)((n < 0) ? -n : n);
+  if (range <= 1)
+    return 0;
+
+  r = rng_next();
+
+  //
+  // Reject the values below 2^32 mod range so that every result is equally
+  // likely. The limit is less than range, so it only needs to be calculated
+  // when r is small.
+  //
+  if (r < range) {
+    limit = (RNG_MASK - range + 1) % range;
+    while (r < limit)
+      r = rng_next();
+  }
+
+  return (long)(r % range);
+}
+
+/* =============================================================================
+ * FUNCTION: write_rng
+ */
+void write_rng(FILE *fp) {
+  bwrite(fp, (char *)rng_state, sizeof(rng_state));
+}
+
+/* =============================================================================
+ * FUNCTION: read_rng
+ */
+void read_rng(FILE *fp) {
+  bread(fp, (char *)rng_state, sizeof(rng_state));
+
+  if ((rng_state[0] | rng_state[1] | rng_state[2] | rng_state[3]) == 0)
+    rng_state[0] = 1;
+}
@@ -0,0 +1,116 @@
+/* =============================================================================
+ * PROGRAM:  ularn
+ * FILENAME: rng.h
+ *
+ * DESCRIPTION:
+ * This module contains the random number generator for the game.
+ * The generator is xoshiro128** with explicit state, so that games can be
+ * reproduced from a seed and the generator state can be saved with the game.
+ * Random numbers in a range are drawn without modulo bias.
+ *
+ * =============================================================================
+ * EXPORTED VARIABLES
+ *
+ * None
+ *
+ * =============================================================================
+ * EXPORTED FUNCTIONS
+ *
+ * rng_seed  : Seed the random number generator
+ * rng_next  : Get the next 32 bit random number
+ * rng_below : Get a random number in the range 0 to n-1
+ * write_rng : Write the random number generator state to the save file
+ * read_rng  : Read the random number generator state from the save file
+ *
+ * =============================================================================
+ */
+
+#ifndef __RNG_H
+# define __RNG_H
+
+# include <stdio.h>
+
+/* =============================================================================
+ * FUNCTION: rng_seed
+ *
+ * DESCRIPTION:
+ * Seed the random number generator.
+ * The same seed always produces the same sequence of random numbers.
+ *
+ * PARAMETERS:
+ *
+ *   seed : The seed value.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+void rng_seed(unsigned long seed);
+
+/* =============================================================================
+ * FUNCTION: rng_next
+ *
+ * DESCRIPTION:
+ * Get the next random number from the generator.
+ *
+ * PARAMETERS:
+ *
+ *   None.
+ *
+ * RETURN VALUE:
+ *
+ *   A uniformly distributed random number in the range 0 to 0xffffffff.
+ */
+unsigned long rng_next(void);
+
+/* =============================================================================
+ * FUNCTION: rng_below
+ *
+ * DESCRIPTION:
+ * Get a uniformly distributed random number in the range 0 to |n|-1.
+ * This is the basis for the rnd, rndl, rund and rundl macros.
+ * As for the % operator that it replaces, the sign of n is ignored.
+ *
+ * PARAMETERS:
+ *
+ *   n : The size of the range. This must not exceed 0xffffffff.
+ *
+ * RETURN VALUE:
+ *
+ *   The random number, or 0 if n is 0.
+ */
+long rng_below(long n);
+
+/* =============================================================================
+ * FUNCTION: write_rng
+ *
+ * DESCRIPTION:
+ * Write the random number generator state to the save file.
+ *
+ * PARAMETERS:
+ *
+ *   fp : A pointer to the save file being written.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+void write_rng(FILE *fp);
+
+/* =============================================================================
+ * FUNCTION: read_rng
+ *
+ * DESCRIPTION:
+ * Read the random number generator state from the save file.
+ *
+ * PARAMETERS:
+ *
+ *   fp : A pointer to the save file being read.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+void read_rng(FILE *fp);
+
+#endif
@@ -21,12 +21,14 @@
 
 #include <fcntl.h>
 #include <stdio.h>
+#include <time.h>
 
 #include "dungeon.h"
 #include "header.h"
 #include "itm.h"
 #include "monster.h"
 #include "player.h"
+#include "rng.h"
 #include "savegame.h"
 #include "saveutils.h"
 #include "scores.h"
@@ -161,12 +163,15 @@ int savegame(char *fname) {
   }
 
   FileSum = 0;
+  FileSumType = SUM_FAST;
 
+  write_save_header(fp);
   write_player(fp);
   write_levels(fp);
   write_store(fp);
   write_monster_data(fp);
   write_spheres(fp);
+  write_rng(fp);
 
   /* file sum */
   bwrite(fp, (char *)&FileSum, sizeof(FileSum));
@@ -183,6 +188,7 @@ int savegame(char *fname) {
  */
 void restoregame(char *fname) {
   int i;
+  int version;
   unsigned int thesum;
   unsigned int asum;
   int TotalAttr;
@@ -203,12 +209,32 @@ void restoregame(char *fname) {
 
   FileSum = 0;
 
+  version = read_save_header(fp);
+  if ((version < 0) || (version > SAVE_VERSION)) {
+    /* leave the save file for a version that can read it */
+    fclose(fp);
+    Printf("Save file <%s> is from a newer version of VLarn\n", fname);
+    nap(4000);
+    c[GOLD] = c[BANKACCOUNT] = 0;
+    died(DIED_OLD_SAVE_FILE, 0);
+    return;
+  }
+
   read_player(fp);
   read_levels(fp);
   read_store(fp);
   read_monster_data(fp);
   read_spheres(fp);
 
+  //
+  // Files without a header don't hold the random number generator state,
+  // so start it from the time as a new game does
+  //
+  if (version >= 1)
+    read_rng(fp);
+  else
+    rng_seed((unsigned long)time(NULL));
+
   /* sum of everything so far */
   thesum = FileSum;
 
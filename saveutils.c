@@ -8,20 +8,25 @@
  * =============================================================================
  * EXPORTED VARIABLES
  *
- * FileSum : The current checksum for the file being written/read.
+ * FileSum     : The current checksum for the file being written/read.
+ * FileSumType : The checksum function used for the file being written/read.
  *
  * =============================================================================
  * EXPORTED FUNCTIONS
  *
- * sum    : Checksum calculation function
- * bwrite : Binary write with checksum update
- * bread  : Binary read with checksum update.
+ * sum     : Checksum calculation function
+ * fastsum : Fast checksum calculation function
+ * bwrite  : Binary write with checksum update
+ * bread   : Binary read with checksum update.
+ * write_save_header : Write the save file format header
+ * read_save_header  : Read the save file format header
  *
  * =============================================================================
  */
 
 #include <errno.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "saveutils.h"
 #include "scores.h"
@@ -32,16 +37,50 @@
  */
 
 /* The number of characters written */
-static int w = 0;
+static GAME_LOCAL int w = 0;
 
 /* The number of characters read */
-static int r = 0;
+static GAME_LOCAL int r = 0;
+
+/*
+ * Constants for fastsum
+ */
+#define FASTSUM_SEED 0x9e3779b97f4a7c15ULL
+#define FASTSUM_PRIME 0xff51afd7ed558ccdULL
+
+typedef unsigned long long FastSumWord;
+
+/* =============================================================================
+ * Local functions
+ */
+
+/* =============================================================================
+ * FUNCTION: fastsum_mix
+ *
+ * DESCRIPTION:
+ * Mix a word into a fastsum lane.
+ *
+ * PARAMETERS:
+ *
+ *   h : The lane so far
+ *
+ *   w : The word to mix in
+ *
+ * RETURN VALUE:
+ *
+ *   The updated lane.
+ */
+static FastSumWord fastsum_mix(FastSumWord h, FastSumWord w) {
+  h = (h ^ w) * FASTSUM_PRIME;
+  return h ^ (h >> 29);
+}
 
 /* =============================================================================
  * Exported variables
  */
 
-int FileSum;
+GAME_LOCAL unsigned int FileSum;
+GAME_LOCAL SumType FileSumType = SUM_LEGACY;
 
 /* =============================================================================
  * Exported functions
@@ -67,12 +106,55 @@ unsigned int sum(unsigned char *data, int n) {
   return sum;
 }
 
+/* =============================================================================
+ * FUNCTION: fastsum
+ */
+unsigned int fastsum(const void *data, long n) {
+  const unsigned char *p = (const unsigned char *)data;
+  FastSumWord h0, h1, h2, h3;
+  FastSumWord w[4];
+
+  h0 = FASTSUM_SEED ^ (FastSumWord)n;
+  h1 = h0 + 1;
+  h2 = h0 + 2;
+  h3 = h0 + 3;
+
+  //
+  // The lanes are independent so that the multiplies can overlap.
+  // The words are copied out so that the data needn't be aligned.
+  //
+  while (n >= (long)sizeof(w)) {
+    memcpy(w, p, sizeof(w));
+    h0 = fastsum_mix(h0, w[0]);
+    h1 = fastsum_mix(h1, w[1]);
+    h2 = fastsum_mix(h2, w[2]);
+    h3 = fastsum_mix(h3, w[3]);
+    p += sizeof(w);
+    n -= (long)sizeof(w);
+  }
+
+  if (n > 0) {
+    memset(w, 0, sizeof(w));
+    memcpy(w, p, n);
+    h0 = fastsum_mix(h0, w[0]);
+    h1 = fastsum_mix(h1, w[1]);
+    h2 = fastsum_mix(h2, w[2]);
+    h3 = fastsum_mix(h3, w[3]);
+  }
+
+  h0 = fastsum_mix(h0, h1);
+  h0 = fastsum_mix(h0, h2);
+  h0 = fastsum_mix(h0, h3);
+
+  return (unsigned int)(h0 ^ (h0 >> 32));
+}
+
 /* =============================================================================
  * FUNCTION: bwrite
  */
 void bwrite(FILE *fp, char *buf, long num) {
   int nwrote;
-  static int ncalls = 0;
+  static GAME_LOCAL int ncalls = 0;
 
   ncalls++;
   nwrote = fwrite(buf, 1, num, fp);
@@ -90,7 +172,10 @@ void bwrite(FILE *fp, char *buf, long num) {
     died(DIED_POST_MORTEM_DEATH, 0);
   }
 
-  FileSum += sum((unsigned char *)buf, num);
+  if (FileSumType == SUM_FAST)
+    FileSum += fastsum(buf, num);
+  else
+    FileSum += sum((unsigned char *)buf, num);
 }
 
 /* =============================================================================
@@ -98,7 +183,7 @@ void bwrite(FILE *fp, char *buf, long num) {
  */
 void bread(FILE *fp, char *buf, long num) {
   int nread;
-  static int ncalls = 0;
+  static GAME_LOCAL int ncalls = 0;
 
   ncalls++;
   nread = fread(buf, 1, num, fp);
@@ -116,5 +201,54 @@ void bread(FILE *fp, char *buf, long num) {
     died(DIED_POST_MORTEM_DEATH, 0);
   }
 
-  FileSum += sum((unsigned char *)buf, num);
+  if (FileSumType == SUM_FAST)
+    FileSum += fastsum(buf, num);
+  else
+    FileSum += sum((unsigned char *)buf, num);
+}
+
+/* =============================================================================
+ * FUNCTION: write_save_header
+ */
+void write_save_header(FILE *fp) {
+  int version = SAVE_VERSION;
+  int type = (int)FileSumType;
+
+  bwrite(fp, SAVE_MAGIC, SAVE_MAGIC_LEN);
+  bwrite(fp, (char *)&version, sizeof(version));
+  bwrite(fp, (char *)&type, sizeof(type));
+}
+
+/* =============================================================================
+ * FUNCTION: read_save_header
+ */
+int read_save_header(FILE *fp) {
+  char magic[SAVE_MAGIC_LEN];
+  int version;
+  int type;
+
+  if ((fread(magic, 1, SAVE_MAGIC_LEN, fp) != SAVE_MAGIC_LEN) ||
+      (memcmp(magic, SAVE_MAGIC, SAVE_MAGIC_LEN) != 0)) {
+    /* no header, so the file is from before the fast checksum */
+    fseek(fp, 0L, SEEK_SET);
+    FileSumType = SUM_LEGACY;
+    return 0;
+  }
+
+  if ((fread(&version, 1, sizeof(version), fp) != sizeof(version)) ||
+      (fread(&type, 1, sizeof(type), fp) != sizeof(type)) || (type < 0) ||
+      (type >= SUM_COUNT))
+    return -1;
+
+  /*
+   * Read the header again with the file's checksum function so that it is
+   * included in the checksum
+   */
+  FileSumType = (SumType)type;
+  fseek(fp, 0L, SEEK_SET);
+  bread(fp, magic, SAVE_MAGIC_LEN);
+  bread(fp, (char *)&version, sizeof(version));
+  bread(fp, (char *)&type, sizeof(type));
+
+  return version;
 }
@@ -8,14 +8,18 @@
  * =============================================================================
  * EXPORTED VARIABLES
  *
- * FileSum : The current checksum for the file being written/read.
+ * FileSum     : The current checksum for the file being written/read.
+ * FileSumType : The checksum function used for the file being written/read.
  *
  * =============================================================================
  * EXPORTED FUNCTIONS
  *
- * sum    : Checksum calculation function
- * bwrite : Binary write with checksum update
- * bread  : Binary read with checksum update.
+ * sum     : Checksum calculation function
+ * fastsum : Fast checksum calculation function
+ * bwrite  : Binary write with checksum update
+ * bread   : Binary read with checksum update.
+ * write_save_header : Write the save file format header
+ * read_save_header  : Read the save file format header
  *
  * =============================================================================
  */
@@ -25,10 +29,41 @@
 
 # include <stdio.h>
 
+# include "config.h"
+
+/*
+ * The checksum functions for save files.
+ */
+typedef enum {
+  SUM_LEGACY,
+  SUM_FAST,
+  SUM_COUNT
+} SumType;
+
+/*
+ * Save files start with a header holding SAVE_MAGIC, the format version and
+ * the checksum function used for the file (SumType).
+ * The first byte of the magic is 0, which can't start the character class
+ * that files without a header (format version 0) start with.
+ *
+ * Format versions:
+ *   0 : No header, the checksum is sum and there is no random number
+ *       generator state.
+ *   1 : The random number generator state follows the spheres.
+ */
+# define SAVE_MAGIC "\0VLS"
+# define SAVE_MAGIC_LEN 4
+# define SAVE_VERSION 1
+
 /*
  * This is the current checksum value for bread and bwrite.
  */
-extern int FileSum;
+extern GAME_LOCAL unsigned int FileSum;
+
+/*
+ * This is the checksum function bread and bwrite use to update FileSum.
+ */
+extern GAME_LOCAL SumType FileSumType;
 
 /* =============================================================================
  * FUNCTION: sum
@@ -48,6 +83,26 @@ extern int FileSum;
  */
 unsigned int sum(unsigned char *data, int n);
 
+/* =============================================================================
+ * FUNCTION: fastsum
+ *
+ * DESCRIPTION:
+ * Fast checksum calculation function.
+ * The data is mixed a machine word at a time, in four independent lanes, so
+ * this is many times faster than sum for large blocks.
+ *
+ * PARAMETERS:
+ *
+ *   data : A pointer to the data to be checksummed
+ *
+ *   n    : The number of bytes in Data to be checksummed
+ *
+ * RETURN VALUE:
+ *
+ *   The checksum of data.
+ */
+unsigned int fastsum(const void *data, long n);
+
 /* =============================================================================
  * FUNCTION: bwrite
  *
@@ -92,4 +147,41 @@ void bwrite(FILE *fp, char *buf, long num);
  */
 void bread(FILE *fp, char *buf, long num);
 
+/* =============================================================================
+ * FUNCTION: write_save_header
+ *
+ * DESCRIPTION:
+ * Write the save file header for the current format version and
+ * FileSumType. This must be the first thing written to the file.
+ *
+ * PARAMETERS:
+ *
+ *   fp : A pointer to the file being written
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+void write_save_header(FILE *fp);
+
+/* =============================================================================
+ * FUNCTION: read_save_header
+ *
+ * DESCRIPTION:
+ * Read the save file header, if the file has one, and set FileSumType to
+ * the checksum function the file uses. The file must be positioned at its
+ * start, and is left positioned after the header.
+ *
+ * PARAMETERS:
+ *
+ *   fp : A pointer to the file being read
+ *
+ * RETURN VALUE:
+ *
+ *   The format version of the file. This is 0 if the file has no header,
+ *   and -1 if the header names a checksum function this version doesn't
+ *   have.
+ */
+int read_save_header(FILE *fp);
+
 #endif
@@ -19,6 +19,10 @@
  * paytaxes      : Note the payment of taxes.
  * showscores    : Display the scoreboard
  * showallscores : Show scores including inventories.
+ * sortboard     : Sort the scoreboard.
+ * calc_score    : Calculate the player's score.
+ * died_reason   : Get the description of a died reason.
+ * set_game_over : Set a function to handle the end of the game.
  * endgame       : Game tidyup and exit function.
  * died          : Function to handle player dying.
  *
@@ -32,12 +36,15 @@
 #include "monster.h"
 #include "player.h"
 #include "potion.h"
+#include "profile.h"
+#include "vclock.h"
 #include "scroll.h"
 #include "show.h"
 #include "sphere.h"
 #include "store.h"
 #include "ularn_ask.h"
 #include "ularn_game.h"
+#include "ularn_script.h"
 #include "ularn_win.h"
 
 /* =============================================================================
@@ -89,10 +96,10 @@ struct win_score_type {
 };
 
 /* storage for the scoreboard  */
-static struct score_type scoreboard[SCORESIZE];
+static GAME_LOCAL struct score_type scoreboard[SCORESIZE];
 
 /* storage for the winners scoreboard */
-static struct win_score_type winboard[SCORESIZE];
+static GAME_LOCAL struct win_score_type winboard[SCORESIZE];
 
 /* Died reason messages */
 static char *whydead[DIED_COUNT] = {"killed by a monster",
@@ -132,98 +139,23 @@ static char *whydead[DIED_COUNT] = {"killed by a monster",
 /*
  * The last error reading/writing the score file
  */
-static int scorerror = 0;
+static GAME_LOCAL int scorerror = 0;
 
 /*
  * The score to highlight when showing the score board
  * This is set to the player's score if it is better that the previous score
  */
-static int highlight_pos = -1;
-static int highlight_win = 0;
+static GAME_LOCAL int highlight_pos = -1;
+static GAME_LOCAL int highlight_win = 0;
 
-/* =============================================================================
- * Local functions
+/*
+ * The function to call at the end of the game, if not the normal processing
  */
+static GAME_LOCAL GameOverFunc game_over = NULL;
 
 /* =============================================================================
- * FUNCTION: calc_score
- *
- * DESCRIPTION:
- * This function calculates the score for the player.
- *
- * PARAMETERS:
- *
- *   Winner : Indicates if the player is a winner (0 = non-winner, 1 = winner)
- *
- * RETURN VALUE:
- *
- *   The player's score.
+ * Local functions
  */
-static long calc_score(int Winner) {
-  int gold_value;
-  int idx;
-  int dlev;
-  int deepest;
-  int score;
-  int stupidity_penalty;
-
-  /*
-   * Start by calculating the player's net worth, converting items to their
-   * value in gold according to what the trading post would pay.
-   * This is a bit mean for gems as the bank pays 5x this.
-   */
-  gold_value = c[GOLD] + c[BANKACCOUNT];
-
-  for (idx = 0; idx < IVENSIZE; idx++)
-    gold_value += item_value(iven[idx], ivenarg[idx]);
-
-  if (!Winner) {
-    /*
-     * If the player isn't a winner, devalue score value of gold by 1/10.
-     */
-
-    gold_value -= gold_value / 10;
-  } else
-    /* bonus for winning */
-    gold_value += 100000 * c[HARDGAME];
-
-  /*
-   * Add score for the deepest level visited
-   */
-
-  deepest = 0;
-  stupidity_penalty = 1;
-  for (dlev = 0; dlev < NLEVELS; dlev++) {
-    if (beenhere[dlev]) {
-      if ((dlev == MAXLEVEL) && (deepest == 0)) {
-        /* The stupid player went directly into the volcano */
-        if (Winner)
-          /*
-           * If the player actually managed to WIN doing this (pretty unlikely)
-           * then give a reward
-           */
-          gold_value *= 2;
-        else
-          stupidity_penalty = 1;
-      } else
-        deepest = dlev;
-    }
-  }
-
-  if (stupidity_penalty) {
-    deepest = 0;
-    gold_value /= 2;
-  }
-
-  /* Calculate the final score */
-  score = gold_value + c[EXPERIENCE] + deepest * 50;
-
-  /* no negative score */
-  if (score < 0)
-    score = 0;
-
-  return score;
-}
 
 /* =============================================================================
  * FUNCTION: readboard
@@ -343,69 +275,6 @@ static int writeboard(void) {
   return 0;
 }
 
-/* =============================================================================
- * FUNCTION: sortboard
- *
- * DESCRIPTION:
- * Function to calculate the position of each score in the scoreboard.
- * NOTE:
- * Unused score entries must be assigned positions in order for the score
- * update function to operate correctly.
- *
- * PARAMETERS:
- *
- *   None.
- *
- * RETURN VALUE:
- *
- *   0 if no sorting done, else returns 1
- */
-static int sortboard(void) {
-  int i, pos;
-  long largest_score;
-  int largest_score_idx;
-
-  /* mark all scores as unsorted */
-  for (i = 0; i < SCORESIZE; i++) {
-    scoreboard[i].order = -1;
-    winboard[i].order = -1;
-  }
-
-  /* work out the position of each score in the visitor's board */
-  for (pos = 0; pos < SCORESIZE; pos++) {
-    /* find the score in position pos */
-    largest_score = -1;
-    largest_score_idx = -1;
-    for (i = 0; i < SCORESIZE; i++) {
-      if ((scoreboard[i].order < 0) && (scoreboard[i].score >= largest_score)) {
-        largest_score_idx = i;
-        largest_score = scoreboard[i].score;
-      }
-    }
-
-    if (largest_score_idx >= 0)
-      scoreboard[largest_score_idx].order = (short)pos;
-  }
-
-  /* work out the position of each score in the winner's board */
-  for (pos = 0; pos < SCORESIZE; pos++) {
-    /* find the score in position pos */
-    largest_score = -1;
-    largest_score_idx = -1;
-    for (i = 0; i < SCORESIZE; i++) {
-      if ((winboard[i].order < 0) && (winboard[i].score >= largest_score)) {
-        largest_score_idx = i;
-        largest_score = winboard[i].score;
-      }
-    }
-
-    if (largest_score_idx >= 0)
-      winboard[largest_score_idx].order = (short)pos;
-  }
-
-  return 1;
-}
-
 /* =============================================================================
  * FUNCTION: newscore
  *
@@ -933,10 +802,151 @@ void showallscores(void) {
   get_prompt_input("\nPress return to continue", "\015", 0);
 }
 
+/* =============================================================================
+ * FUNCTION: sortboard
+ */
+int sortboard(void) {
+  int i, pos;
+  long largest_score;
+  int largest_score_idx;
+
+  /* mark all scores as unsorted */
+  for (i = 0; i < SCORESIZE; i++) {
+    scoreboard[i].order = -1;
+    winboard[i].order = -1;
+  }
+
+  /* work out the position of each score in the visitor's board */
+  for (pos = 0; pos < SCORESIZE; pos++) {
+    /* find the score in position pos */
+    largest_score = -1;
+    largest_score_idx = -1;
+    for (i = 0; i < SCORESIZE; i++) {
+      if ((scoreboard[i].order < 0) && (scoreboard[i].score >= largest_score)) {
+        largest_score_idx = i;
+        largest_score = scoreboard[i].score;
+      }
+    }
+
+    if (largest_score_idx >= 0)
+      scoreboard[largest_score_idx].order = (short)pos;
+  }
+
+  /* work out the position of each score in the winner's board */
+  for (pos = 0; pos < SCORESIZE; pos++) {
+    /* find the score in position pos */
+    largest_score = -1;
+    largest_score_idx = -1;
+    for (i = 0; i < SCORESIZE; i++) {
+      if ((winboard[i].order < 0) && (winboard[i].score >= largest_score)) {
+        largest_score_idx = i;
+        largest_score = winboard[i].score;
+      }
+    }
+
+    if (largest_score_idx >= 0)
+      winboard[largest_score_idx].order = (short)pos;
+  }
+
+  return 1;
+}
+
+/* =============================================================================
+ * FUNCTION: calc_score
+ */
+long calc_score(int Winner) {
+  int gold_value;
+  int idx;
+  int dlev;
+  int deepest;
+  int score;
+  int stupidity_penalty;
+
+  /*
+   * Start by calculating the player's net worth, converting items to their
+   * value in gold according to what the trading post would pay.
+   * This is a bit mean for gems as the bank pays 5x this.
+   */
+  gold_value = c[GOLD] + c[BANKACCOUNT];
+
+  for (idx = 0; idx < IVENSIZE; idx++)
+    gold_value += item_value(iven[idx], ivenarg[idx]);
+
+  if (!Winner) {
+    /*
+     * If the player isn't a winner, devalue score value of gold by 1/10.
+     */
+
+    gold_value -= gold_value / 10;
+  } else
+    /* bonus for winning */
+    gold_value += 100000 * c[HARDGAME];
+
+  /*
+   * Add score for the deepest level visited
+   */
+
+  deepest = 0;
+  stupidity_penalty = 1;
+  for (dlev = 0; dlev < NLEVELS; dlev++) {
+    if (beenhere[dlev]) {
+      if ((dlev == MAXLEVEL) && (deepest == 0)) {
+        /* The stupid player went directly into the volcano */
+        if (Winner)
+          /*
+           * If the player actually managed to WIN doing this (pretty unlikely)
+           * then give a reward
+           */
+          gold_value *= 2;
+        else
+          stupidity_penalty = 1;
+      } else
+        deepest = dlev;
+    }
+  }
+
+  if (stupidity_penalty) {
+    deepest = 0;
+    gold_value /= 2;
+  }
+
+  /* Calculate the final score */
+  score = gold_value + c[EXPERIENCE] + deepest * 50;
+
+  /* no negative score */
+  if (score < 0)
+    score = 0;
+
+  return score;
+}
+
+/* =============================================================================
+ * FUNCTION: died_reason
+ */
+char *died_reason(DiedReasonType Reason) {
+  if ((Reason < 0) || (Reason >= DIED_COUNT))
+    return NULL;
+
+  return whydead[Reason];
+}
+
+/* =============================================================================
+ * FUNCTION: set_game_over
+ */
+void set_game_over(GameOverFunc GameOver) { game_over = GameOver; }
+
 /* =============================================================================
  * FUNCTION: endgame
  */
 void endgame(void) {
+  int status;
+
+  if (game_over != NULL)
+    game_over(DIED_QUICK_QUIT, 0);
+
+  /* record or check the final state of a game trace */
+  script_game_over();
+
   /* deallocate any allocated memory */
 
   free_cells();
@@ -945,8 +955,17 @@ void endgame(void) {
   /* close the application */
   close_app();
 
+  /* report the replay rate if input was scripted */
+  status = script_close() ? 0 : 1;
+
+  /* report the turn profile if profiling */
+  profile_close();
+
+  /* report the time spent in delays */
+  vclock_report();
+
   /* and exit */
-  exit(0);
+  exit(status);
 }
 
 /* =============================================================================
@@ -1001,6 +1020,10 @@ void died(DiedReasonType Reason, int Monster) {
   if (ckpflag)
     unlink(ckpfile);
 
+  /* let the game runner handle the end of the game, if there is one */
+  if (game_over != NULL)
+    game_over(Reason, Monster);
+
   /* if we are not to display the scores */
   if ((Reason == DIED_QUICK_QUIT) || (Reason == DIED_SUSPENDED)) {
     /* for quick exit or saved game */
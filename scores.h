@@ -19,6 +19,10 @@
  * paytaxes      : Note the payment of taxes.
  * showscores    : Display the scoreboard
  * showallscores : Show scores including inventories.
+ * sortboard     : Sort the scoreboard.
+ * calc_score    : Calculate the player's score.
+ * died_reason   : Get the description of a died reason.
+ * set_game_over : Set a function to handle the end of the game.
  * endgame       : Game tidyup and exit function.
  * died          : Function to handle player dying.
  *
@@ -70,6 +74,12 @@ typedef enum {
   DIED_COUNT
 } DiedReasonType;
 
+/*
+ * A function to be called in place of the normal end of game processing.
+ * This must not return.
+ */
+typedef void (*GameOverFunc)(DiedReasonType Reason, int Monster);
+
 /* =============================================================================
  * FUNCTION: makeboard
  *
@@ -155,6 +165,78 @@ void showscores(void);
  */
 void showallscores(void);
 
+/* =============================================================================
+ * FUNCTION: sortboard
+ *
+ * DESCRIPTION:
+ * Function to calculate the position of each score in the scoreboard.
+ * NOTE:
+ * Unused score entries must be assigned positions in order for the score
+ * update function to operate correctly.
+ *
+ * PARAMETERS:
+ *
+ *   None.
+ *
+ * RETURN VALUE:
+ *
+ *   0 if no sorting done, else returns 1
+ */
+int sortboard(void);
+
+/* =============================================================================
+ * FUNCTION: calc_score
+ *
+ * DESCRIPTION:
+ * This function calculates the score for the player.
+ *
+ * PARAMETERS:
+ *
+ *   Winner : Indicates if the player is a winner (0 = non-winner, 1 = winner)
+ *
+ * RETURN VALUE:
+ *
+ *   The player's score.
+ */
+long calc_score(int Winner);
+
+/* =============================================================================
+ * FUNCTION: died_reason
+ *
+ * DESCRIPTION:
+ * Get the scoreboard description of a died reason.
+ *
+ * PARAMETERS:
+ *
+ *   Reason : The reason the player died
+ *
+ * RETURN VALUE:
+ *
+ *   The description, or NULL if the reason is not shown on the scoreboard.
+ */
+char *died_reason(DiedReasonType Reason);
+
+/* =============================================================================
+ * FUNCTION: set_game_over
+ *
+ * DESCRIPTION:
+ * Set a function to be called when the game ends, instead of showing the
+ * score, updating the scoreboard and exiting the program.
+ * This is used to run games without a player, where the end of one game must
+ * not end the process. The function is called with the game state intact
+ * (other than life protection being used) and must not return.
+ * The setting applies to the current thread's game only.
+ *
+ * PARAMETERS:
+ *
+ *   GameOver : The function to call, or NULL for the normal processing.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+void set_game_over(GameOverFunc GameOver);
+
 /* =============================================================================
  * FUNCTION: endgame
  *
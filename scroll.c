@@ -20,6 +20,8 @@
  * =============================================================================
  */
 
+#include <string.h>
+
 #include "scroll.h"
 #include "dungeon.h"
 #include "dungeon_obj.h"
@@ -72,7 +74,7 @@ char *scrollname[MAXSCROLL] = {" enchant armor",
 /*
  * data for the function to read a scroll
  */
-static int xh, yh, yl, xl;
+static GAME_LOCAL int xh, yh, yl, xl;
 
 /*
  * List of attributes affected by spell extension
@@ -145,8 +147,8 @@ void read_scroll(int typ) {
     xh = min(playerx + 25, MAXX);
     yl = max(playery - 7, 0);
     xl = max(playerx - 25, 0);
-    for (i = yl; i < yh; i++) {
-      for (j = xl; j < xh; j++) {
+    for (j = xl; j < xh; j++) {
+      for (i = yl; i < yh; i++) {
         know[j][i] = item[j][i];
         if (mitem[j][i].mon != MONST_NONE)
           stealth[j][i] |= STEALTH_SEEN;
@@ -206,8 +208,8 @@ void read_scroll(int typ) {
     return;
 
   case SMONSTHEAL:
-    for (i = 0; i < MAXY; i++) {
-      for (j = 0; j < MAXX; j++)
+    for (j = 0; j < MAXX; j++) {
+      for (i = 0; i < MAXY; i++)
         if (mitem[j][i].mon)
           hitp[j][i] = monster[(int)mitem[j][i].mon].hitpoints;
     }
@@ -230,13 +232,9 @@ void read_scroll(int typ) {
     return;
 
   case SMAGICMAP:
-    for (i = 0; i < MAXY; i++) {
-      for (j = 0; j < MAXX; j++) {
-        know[j][i] = item[j][i];
-        if (mitem[j][i].mon != MONST_NONE)
-          stealth[j][i] |= STEALTH_SEEN;
-      }
-    }
+    memcpy(know, item, LEVEL_CHARS);
+    for (i = 0; i < roster_count; i++)
+      stealth[(int)roster[i].x][(int)roster[i].y] |= STEALTH_SEEN;
     nap(2000);
     draws(0, MAXX, 0, MAXY);
     return;
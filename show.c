@@ -47,8 +47,8 @@
 /*
  * See magic function line and position counts. Used for paginating see magic.
  */
-static int lincount;
-static int count;
+static GAME_LOCAL int lincount;
+static GAME_LOCAL int count;
 
 /* =============================================================================
  * Local functions
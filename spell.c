@@ -630,6 +630,7 @@ static void vaporize_rock(void) {
       }
 
       item[i][j] = it;
+      item_update(i, j);
     }
   }
 
@@ -836,6 +837,7 @@ static void makewall(SpellType spnum) {
           if ((level != 1) || (x != 33) || (y != MAXY - 1)) {
             do_magic_fx(x, y, MAGIC_WALL);
             item[x][y] = OWALL;
+            item_update(x, y);
             show1cell(x, y);
 
             /* Work out the new wall tiles for adjacent walls */
@@ -993,6 +995,7 @@ static void dirpoly(SpellType spnum) {
     m = rnd(MAXMONST + 7);
     mitem[x][y].mon = (char)m;
   } while ((monster[m].flags & FL_GENOCIDED) != 0);
+  roster_update(x, y);
 
   hitp[x][y] = monster[m].hitpoints;
   show1cell(x, y); /* show the new monster */
@@ -1200,8 +1203,8 @@ static void speldamage(SpellType Spell) {
     xh = playerx + 16;
     vxy(xl, yl);
     vxy(xh, yh);               /* check bounds */
-    for (i = yl; i <= yh; i++) /* enlightenment   */
-      for (j = xl; j <= xh; j++)
+    for (j = xl; j <= xh; j++) /* enlightenment   */
+      for (i = yl; i <= yh; i++)
         know[j][i] = item[j][i];
     draws(xl, xh + 1, yl, yh + 1);
     return;
@@ -1458,47 +1461,36 @@ static void speldamage(SpellType Spell) {
         mitem[i][j].mon = MONST_NONE;
       }
     }
+    roster_rebuild();
 
     eat(1, 1);
 
-    if (level == 1)
+    if (level == 1) {
       item[33][MAXY - 1] = ONOTHING;
+      item_update(33, MAXY - 1);
+    }
 
-    for (j = rnd(MAXY - 2), i = 1; i < MAXX - 1; i++)
+    for (j = rnd(MAXY - 2), i = 1; i < MAXX - 1; i++) {
       item[i][j] = ONOTHING;
+      item_update(i, j);
+    }
 
     /* put objects back in level */
     while (sc > 0) {
       --sc;
+      if (!pick_empty_cell(&i, &j))
+        /* the level is full, so the rest are lost */
+        continue;
+
       if (save[sc].type == 0) {
-        int trys;
-
-        trys = 100;
-        do {
-          trys--;
-          i = rnd(MAXX - 1);
-          j = rnd(MAXY - 1);
-        } while ((trys > 0) && (item[i][j] != ONOTHING));
-
-        if (trys) {
-          item[i][j] = save[sc].id;
-          iarg[i][j] = save[sc].arg;
-        }
+        item[i][j] = save[sc].id;
+        item_update(i, j);
+        iarg[i][j] = save[sc].arg;
       } else {
         /* put monsters back in */
-        int trys;
-
-        trys = 100;
-        do {
-          trys--;
-          i = rnd(MAXX - 1);
-          j = rnd(MAXY - 1);
-        } while ((trys > 0) && ((item[i][j] == OWALL) || mitem[i][j].mon));
-
-        if (trys) {
-          mitem[i][j].mon = save[sc].id;
-          hitp[i][j] = save[sc].arg;
-        }
+        mitem[i][j].mon = save[sc].id;
+        roster_update(i, j);
+        hitp[i][j] = save[sc].arg;
       }
     }
 
@@ -1629,6 +1621,7 @@ void godirect(SpellType spnum, int dam, char *str, int delay,
             if ((x < MAXX - 1) && (y < MAXY - 1) && (x) && (y)) {
               Print("  The wall crumbles.");
               *it = ONOTHING;
+              item_update(x, y);
               show1cell(x, y);
 
               /* Work out the new wall tiles for adjacent walls */
@@ -1653,6 +1646,7 @@ void godirect(SpellType spnum, int dam, char *str, int delay,
         if (dam >= 40) {
           Print("  The door is blasted apart.");
           *it = ONOTHING;
+          item_update(x, y);
           show1cell(x, y);
         }
         dam = 0;
@@ -1668,6 +1662,7 @@ void godirect(SpellType spnum, int dam, char *str, int delay,
              */
             Print("  The statue crumbles.");
             *it = OBOOK;
+            item_update(x, y);
             iarg[x][y] = (char)level;
             show1cell(x, y);
           }
@@ -1683,8 +1678,10 @@ void godirect(SpellType spnum, int dam, char *str, int delay,
            * If destroying a throne, a gnome king appears
            */
           mitem[x][y].mon = GNOMEKING;
+          roster_update(x, y);
           hitp[x][y] = monster[GNOMEKING].hitpoints;
           *it = OTHRONE2;
+          item_update(x, y);
           show1cell(x, y);
         }
         dam = 0;
@@ -1743,6 +1740,7 @@ void annihilate(void) {
         if (monst < DEMONLORD) {
           xp += monster[monst].experience;
           mitem[x][y].mon = MONST_NONE;
+          roster_update(x, y);
         } else {
           Printf("\nThe %s barely escapes being annihilated!",
                  monster[monst].name);
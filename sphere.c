@@ -20,6 +20,7 @@
  * free_spheres  : Free all allocated spheres
  * write_spheres : Write the spheres to the save file
  * read_spheres  : Read the spheres from the save file
+ * digest_spheres: Add the spheres to a digest
  *
  * =============================================================================
  */
@@ -47,7 +48,7 @@ struct sphere {
 /*
  * The start of the list of spheres
  */
-static struct sphere *spheres = NULL;
+static GAME_LOCAL struct sphere *spheres = NULL;
 
 /*
  * The next sphere to process when processing the movement for list of spheres.
@@ -55,7 +56,7 @@ static struct sphere *spheres = NULL;
  * This may be changed by rmsphere deleting an unprocessed sphere when
  * two spheres collide.
  */
-static struct sphere *sp2;
+static GAME_LOCAL struct sphere *sp2;
 
 /* =============================================================================
  * Local functions
@@ -123,11 +124,13 @@ static void sphboom(int x, int y) {
   for (j = xl; j < xh; j++) {
     for (i = yl; i < yh; i++) {
       item[j][i] = ONOTHING;
+      item_update(j, i);
 
-      if (!mon_has_item(j, i, OSPHTALISMAN))
+      if (!mon_has_item(j, i, OSPHTALISMAN)) {
         /* The monster was caught in the explosion */
         mitem[j][i].mon = MONST_NONE;
-      else {
+        roster_update(j, i);
+      } else {
         /* The monster has the talisman, and is unaffected */
         Printf("\nThe %s is unaffected by the blast!",
                monster[(int)mitem[j][i].mon].name);
@@ -202,6 +205,7 @@ int msphere(struct sphere *sp, int create) {
      */
 
     item[x][y] = ONOTHING;
+    item_update(x, y);
     know[x][y] = item[x][y];
 
     /* show the now moved sphere */
@@ -312,6 +316,7 @@ int msphere(struct sphere *sp, int create) {
 
   /* The sphere still exists, so put it on the map in the new position */
   item[x][y] = OANNIHILATION;
+  item_update(x, y);
 
   if (it == OWALL) {
     /* Destroyed a wall, so analyse wall connections and redisplay */
@@ -330,8 +335,10 @@ int msphere(struct sphere *sp, int create) {
   if (mon_has_talisman)
     Printf("\nThe %s is unaffected by the sphere of annihilation!",
            monster[m].name);
-  else
+  else {
     mitem[x][y].mon = MONST_NONE;
+    roster_update(x, y);
+  }
 
   know[x][y] = item[x][y];
 
@@ -363,6 +370,7 @@ void rmsphere(int x, int y) {
        */
 
       item[x][y] = ONOTHING;
+      item_update(x, y);
       know[x][y] = item[x][y];
 
       /* show the now missing sphere */
@@ -545,3 +553,25 @@ void read_spheres(FILE *fp) {
     count--;
   }
 }
+
+/* =============================================================================
+ * FUNCTION: digest_spheres
+ */
+DigestType digest_spheres(DigestType Digest) {
+  struct sphere *sp;
+  DigestType SphereDigest;
+  DigestType Sum;
+
+  Sum = 0;
+  for (sp = spheres; sp != NULL; sp = sp->next) {
+    SphereDigest = digest_bytes(DIGEST_INIT, &sp->x, sizeof(sp->x));
+    SphereDigest = digest_bytes(SphereDigest, &sp->y, sizeof(sp->y));
+    SphereDigest = digest_bytes(SphereDigest, &sp->lev, sizeof(sp->lev));
+    SphereDigest = digest_bytes(SphereDigest, &sp->dir, sizeof(sp->dir));
+    SphereDigest =
+        digest_bytes(SphereDigest, &sp->lifetime, sizeof(sp->lifetime));
+    Sum += SphereDigest;
+  }
+
+  return digest_bytes(Digest, &Sum, sizeof(Sum));
+}
@@ -20,6 +20,7 @@
  * free_spheres  : Free all allocated spheres
  * write_spheres : Write the spheres to the save file
  * read_spheres  : Read the spheres from the save file
+ * digest_spheres: Add the spheres to a digest
  *
  * =============================================================================
  */
@@ -29,6 +30,8 @@
 
 # include <stdio.h>
 
+# include "digest.h"
+
 /* =============================================================================
  * FUNCTION: rmsphere
  *
@@ -134,4 +137,22 @@ void write_spheres(FILE *fp);
  */
 void read_spheres(FILE *fp);
 
+/* =============================================================================
+ * FUNCTION: digest_spheres
+ *
+ * DESCRIPTION:
+ * Add the spheres of annihilation to a digest.
+ * The result does not depend on the order of the sphere list, which is
+ * reversed when the spheres are read from a save file.
+ *
+ * PARAMETERS:
+ *
+ *   Digest : The digest so far.
+ *
+ * RETURN VALUE:
+ *
+ *   The updated digest.
+ */
+DigestType digest_spheres(DigestType Digest);
+
 #endif
@@ -63,11 +63,10 @@
 /* max # items in the dnd store */
 #define DNDSIZE   93
 
-static int dnditm = 0;
+static GAME_LOCAL int dnditm = 0;
 
 struct _itm {
   long price;
-  int *mem;
   char obj;
   char arg;
   char qty;
@@ -76,130 +75,130 @@ struct _itm {
 /*
  * Store inventory and prices
  */
-static struct _itm itm[DNDSIZE] =  {
-
-/*cost    memory   iven name  iven arg      how
-   gp   pointer  iven[] ivenarg[]     many */
-  {     2,   0,         OLEATHER,     0,     3    },
-  {    10,   0,         OSTUDLEATHER, 0,     2    },
-  {    40,   0,         ORING,        0,     2    },
-  {    85,   0,         OCHAIN,       0,     2    },
-  {   220,   0,         OSPLINT,      0,     1    },
-  {   400,   0,         OPLATE,       0,     1    },
-  {   900,   0,         OPLATEARMOR,  0,     1    },
-  {  2600,   0,         OSSPLATE,     0,     1    },
-  {   150,   0,         OSHIELD,      0,     1    },
-  {  5000,   0,         OELVENCHAIN,  0,     0    },
-  {  1000,   0,         OORB,         0,     0    }, /* 10 */
-  { 10000,   0,         OSLAYER,      0,     0    },
-
-/*cost    memory  iven name iven arg   how
-   gp   pointer    iven[]  ivenarg[]  many */
-
-  {     2,   0,         ODAGGER,           0,     3    },
-  {    20,   0,         OSPEAR,            0,     3    },
-  {    80,   0,         OFLAIL,            0,     2    },
-  {   150,   0,         OBATTLEAXE,        0,     2    },
-  {   450,   0,         OLONGSWORD,        0,     2    },
-  {  1000,   0,         O2SWORD,           0,     2    },
-  {  5000,   0,         OSWORD,            0,     1    },
-  { 20000,   0,         OLANCE,            0,     1    },
-  {  2000,   0,         OSWORDofSLASHING,  0,     0    }, /* 20 */
-  {  7500,   0,         OHAMMER,           0,     0    },
-
-/*cost    memory  iven name iven arg   how
-   gp   pointer    iven[]  ivenarg[]  many */
-  {  150,   0,         OPROTRING,     1,     1    },
-  {   85,   0,         OSTRRING,      1,     1    },
-  {  120,   0,         ODEXRING,      1,     1    },
-  {  120,   0,         OCLEVERRING,   1,     1    },
-  {  180,   0,         OENERGYRING,   0,     1    },
-  {  125,   0,         ODAMRING,      0,     1    },
-  {  220,   0,         OREGENRING,    0,     1    },
-  { 1000,   0,         ORINGOFEXTRA,  0,     1    },
-
-  {  280,   0,         OBELT,         0,     1    }, /* 30 */
-  {  400,   0,         OAMULET,       5,     1    },
-
-  {  500,   0,         OCUBEofUNDEAD, 0,     0    },
-  {  600,   0,         ONOTHEFT,      0,     0    },
-
-  {  590,   0,         OCHEST,        3,     1    },
-  {  200,   0,         OBOOK,         2,     1    },
-  {   10,   0,         OCOOKIE,       0,     3    },
-  {  666,   0,         OHANDofFEAR,   0,     0    },
-
-/*cost    memory  iven name iven arg   how
-   gp   pointer    iven[]  ivenarg[]  many */
-
-  {  20,   potionknown,  OPOTION,      PSLEEP,       6    },
-  {  90,   potionknown,  OPOTION,      PHEALING,     5    },
-  { 520,   potionknown,  OPOTION,      PRAISELEVEL,  1    }, /* 40 */
-  { 100,   potionknown,  OPOTION,      PINCABILITY,  2    },
-  {  50,   potionknown,  OPOTION,      PWISDOM,      2    },
-  { 150,   potionknown,  OPOTION,      PSTRENGTH,    2    },
-  {  70,   potionknown,  OPOTION,      PCHARISMA,    1    },
-  {  30,   potionknown,  OPOTION,      PDIZZINESS,   7    },
-  { 200,   potionknown,  OPOTION,      PLEARNING,    1    },
-  {  50,   potionknown,  OPOTION,      PGOLDDET,     1    },
-  {  80,   potionknown,  OPOTION,      PMONSTDET,    1    },
-
-/*cost    memory  iven name iven arg   how
-   gp   pointer    iven[]  ivenarg[]  many */
-
-  {  30,   potionknown,  OPOTION,      PFORGETFUL,   3    },
-  {  20,   potionknown,  OPOTION,      PWATER,       5    }, /* 50 */
-  {  40,   potionknown,  OPOTION,      PBLINDNESS,   3    },
-  {  35,   potionknown,  OPOTION,      PCONFUSION,   2    },
-  { 520,   potionknown,  OPOTION,      PHEROISM,     1    },
-  {  90,   potionknown,  OPOTION,      PSTURDINESS,  2    },
-  { 200,   potionknown,  OPOTION,      PGIANTSTR,    2    },
-  { 220,   potionknown,  OPOTION,      PFIRERESIST,  4    },
-  {  80,   potionknown,  OPOTION,      PTREASURE,    6    },
-  { 370,   potionknown,  OPOTION,      PINSTHEAL,    3    },
-  {  50,   potionknown,  OPOTION,      PPOISON,      1    },
-  { 150,   potionknown,  OPOTION,      PSEEINVIS,    3    }, /* 60 */
-
-/*cost    memory  iven name iven arg   how
-   gp   pointer    iven[]  ivenarg[]  many */
-
-  {  850,   0,         OORBOFDRAGON,   0,     0    },
-  {  750,   0,         OSPIRITSCARAB,  0,     0    },
-  { 8000,   0,         OVORPAL,        0,     0,    },
-
-  {  100,   scrollknown,  OSCROLL,      SENCHANTARM,  2    },
-  {  125,   scrollknown,  OSCROLL,      SENCHANTWEAP, 2    },
-  {   60,   scrollknown,  OSCROLL,      SENLIGHTEN,   4    },
-  {   10,   scrollknown,  OSCROLL,      SBLANK,       4    },
-  {  100,   scrollknown,  OSCROLL,      SCREATEMONST, 3    },
-  {  200,   scrollknown,  OSCROLL,      SCREATEITEM,  2    },
-  {  110,   scrollknown,  OSCROLL,      SAGGMONST,    1    }, /* 70 */
-  {  500,   scrollknown,  OSCROLL,      STIMEWARP,    2    },
-  {  200,   scrollknown,  OSCROLL,      STELEPORT,    2    },
-  {  250,   scrollknown,  OSCROLL,      SAWARENESS,   4    },
-  {   20,   scrollknown,  OSCROLL,      SHASTEMONST,  5    },
-  {   30,   scrollknown,  OSCROLL,      SMONSTHEAL,   3    },
-
-/*cost    memory  iven name iven arg   how
-   gp   pointer    iven[]  ivenarg[]  many */
-
-  {   340,   scrollknown,  OSCROLL,        SSPIRITPROT,  1    },
-  {   340,   scrollknown,  OSCROLL,        SUNDEADPROT,  1    },
-  {   300,   scrollknown,  OSCROLL,        SSTEALTH,     2    },
-  {   400,   scrollknown,  OSCROLL,        SMAGICMAP,    2    },
-  {   500,   scrollknown,  OSCROLL,        SHOLDMONST,   2    }, /* 80 */
-  {  1000,   scrollknown,  OSCROLL,        SGEMPERFECT,  1    },
-  {   500,   scrollknown,  OSCROLL,        SSPELLEXT,    1    },
-  {   340,   scrollknown,  OSCROLL,        SIDENTIFY,    2    },
-  {   220,   scrollknown,  OSCROLL,        SREMCURSE,    3    },
-  {  3900,   scrollknown,  OSCROLL,        SANNIHILATE,  0    },
-  {   610,   scrollknown,  OSCROLL,        SPULVERIZE,   1    },
-  {  3000,   scrollknown,  OSCROLL,        SLIFEPROT,    0    },
-  {   300,   0,            OSPHTALISMAN,   0,            0    },
-  {   150,   0,            OWWAND,         0,            0    },
-  {    50,   0,            OBRASSLAMP,     0,            0    }, /* 90 */
-  {  9500,   0,            OPSTAFF,        0,            0    },
-  { 10000,   0,            OLIFEPRESERVER, 0,            0    }
+static GAME_LOCAL struct _itm itm[DNDSIZE] =  {
+
+/*cost    iven name  iven arg      how
+   gp    iven[] ivenarg[]     many */
+  {     2,   OLEATHER,     0,     3    },
+  {    10,   OSTUDLEATHER, 0,     2    },
+  {    40,   ORING,        0,     2    },
+  {    85,   OCHAIN,       0,     2    },
+  {   220,   OSPLINT,      0,     1    },
+  {   400,   OPLATE,       0,     1    },
+  {   900,   OPLATEARMOR,  0,     1    },
+  {  2600,   OSSPLATE,     0,     1    },
+  {   150,   OSHIELD,      0,     1    },
+  {  5000,   OELVENCHAIN,  0,     0    },
+  {  1000,   OORB,         0,     0    }, /* 10 */
+  { 10000,   OSLAYER,      0,     0    },
+
+/*cost    iven name iven arg   how
+   gp      iven[]  ivenarg[]  many */
+
+  {     2,   ODAGGER,           0,     3    },
+  {    20,   OSPEAR,            0,     3    },
+  {    80,   OFLAIL,            0,     2    },
+  {   150,   OBATTLEAXE,        0,     2    },
+  {   450,   OLONGSWORD,        0,     2    },
+  {  1000,   O2SWORD,           0,     2    },
+  {  5000,   OSWORD,            0,     1    },
+  { 20000,   OLANCE,            0,     1    },
+  {  2000,   OSWORDofSLASHING,  0,     0    }, /* 20 */
+  {  7500,   OHAMMER,           0,     0    },
+
+/*cost    iven name iven arg   how
+   gp      iven[]  ivenarg[]  many */
+  {  150,   OPROTRING,     1,     1    },
+  {   85,   OSTRRING,      1,     1    },
+  {  120,   ODEXRING,      1,     1    },
+  {  120,   OCLEVERRING,   1,     1    },
+  {  180,   OENERGYRING,   0,     1    },
+  {  125,   ODAMRING,      0,     1    },
+  {  220,   OREGENRING,    0,     1    },
+  { 1000,   ORINGOFEXTRA,  0,     1    },
+
+  {  280,   OBELT,         0,     1    }, /* 30 */
+  {  400,   OAMULET,       5,     1    },
+
+  {  500,   OCUBEofUNDEAD, 0,     0    },
+  {  600,   ONOTHEFT,      0,     0    },
+
+  {  590,   OCHEST,        3,     1    },
+  {  200,   OBOOK,         2,     1    },
+  {   10,   OCOOKIE,       0,     3    },
+  {  666,   OHANDofFEAR,   0,     0    },
+
+/*cost    iven name iven arg   how
+   gp      iven[]  ivenarg[]  many */
+
+  {  20,   OPOTION,      PSLEEP,       6    },
+  {  90,   OPOTION,      PHEALING,     5    },
+  { 520,   OPOTION,      PRAISELEVEL,  1    }, /* 40 */
+  { 100,   OPOTION,      PINCABILITY,  2    },
+  {  50,   OPOTION,      PWISDOM,      2    },
+  { 150,   OPOTION,      PSTRENGTH,    2    },
+  {  70,   OPOTION,      PCHARISMA,    1    },
+  {  30,   OPOTION,      PDIZZINESS,   7    },
+  { 200,   OPOTION,      PLEARNING,    1    },
+  {  50,   OPOTION,      PGOLDDET,     1    },
+  {  80,   OPOTION,      PMONSTDET,    1    },
+
+/*cost    iven name iven arg   how
+   gp      iven[]  ivenarg[]  many */
+
+  {  30,   OPOTION,      PFORGETFUL,   3    },
+  {  20,   OPOTION,      PWATER,       5    }, /* 50 */
+  {  40,   OPOTION,      PBLINDNESS,   3    },
+  {  35,   OPOTION,      PCONFUSION,   2    },
+  { 520,   OPOTION,      PHEROISM,     1    },
+  {  90,   OPOTION,      PSTURDINESS,  2    },
+  { 200,   OPOTION,      PGIANTSTR,    2    },
+  { 220,   OPOTION,      PFIRERESIST,  4    },
+  {  80,   OPOTION,      PTREASURE,    6    },
+  { 370,   OPOTION,      PINSTHEAL,    3    },
+  {  50,   OPOTION,      PPOISON,      1    },
+  { 150,   OPOTION,      PSEEINVIS,    3    }, /* 60 */
+
+/*cost    iven name iven arg   how
+   gp      iven[]  ivenarg[]  many */
+
+  {  850,   OORBOFDRAGON,   0,     0    },
+  {  750,   OSPIRITSCARAB,  0,     0    },
+  { 8000,   OVORPAL,        0,     0,    },
+
+  {  100,   OSCROLL,      SENCHANTARM,  2    },
+  {  125,   OSCROLL,      SENCHANTWEAP, 2    },
+  {   60,   OSCROLL,      SENLIGHTEN,   4    },
+  {   10,   OSCROLL,      SBLANK,       4    },
+  {  100,   OSCROLL,      SCREATEMONST, 3    },
+  {  200,   OSCROLL,      SCREATEITEM,  2    },
+  {  110,   OSCROLL,      SAGGMONST,    1    }, /* 70 */
+  {  500,   OSCROLL,      STIMEWARP,    2    },
+  {  200,   OSCROLL,      STELEPORT,    2    },
+  {  250,   OSCROLL,      SAWARENESS,   4    },
+  {   20,   OSCROLL,      SHASTEMONST,  5    },
+  {   30,   OSCROLL,      SMONSTHEAL,   3    },
+
+/*cost    iven name iven arg   how
+   gp      iven[]  ivenarg[]  many */
+
+  {   340,   OSCROLL,        SSPIRITPROT,  1    },
+  {   340,   OSCROLL,        SUNDEADPROT,  1    },
+  {   300,   OSCROLL,        SSTEALTH,     2    },
+  {   400,   OSCROLL,        SMAGICMAP,    2    },
+  {   500,   OSCROLL,        SHOLDMONST,   2    }, /* 80 */
+  {  1000,   OSCROLL,        SGEMPERFECT,  1    },
+  {   500,   OSCROLL,        SSPELLEXT,    1    },
+  {   340,   OSCROLL,        SIDENTIFY,    2    },
+  {   220,   OSCROLL,        SREMCURSE,    3    },
+  {  3900,   OSCROLL,        SANNIHILATE,  0    },
+  {   610,   OSCROLL,        SPULVERIZE,   1    },
+  {  3000,   OSCROLL,        SLIFEPROT,    0    },
+  {   300,   OSPHTALISMAN,   0,            0    },
+  {   150,   OWWAND,         0,            0    },
+  {    50,   OBRASSLAMP,     0,            0    }, /* 90 */
+  {  9500,   OPSTAFF,        0,            0    },
+  { 10000,   OLIFEPRESERVER, 0,            0    }
 };
 
 /* =============================================================================
@@ -479,8 +478,10 @@ void dndstore(void)
         nogold();
       else{
         /* Player learns this item */
-        if (itm[i].mem != 0)
-          itm[i].mem[(int)itm[i].arg] = 1;
+        if (itm[i].obj == OPOTION)
+          potionknown[(int)itm[i].arg] = 1;
+        else if (itm[i].obj == OSCROLL)
+          scrollknown[(int)itm[i].arg] = 1;
 
         c[GOLD] -= itm[i].price * 10L;
         itm[i].qty--;
@@ -515,8 +516,8 @@ void dndstore(void)
 
 /* the list of courses taken and the time required */
 #define MAX_COURSES 8
-char course[MAX_COURSES] = { 0, 0, 0, 0, 0, 0, 0, 0 };
-char coursetime[MAX_COURSES] = { 10, 15, 10, 20, 10, 10, 10, 5 };
+GAME_LOCAL char course[MAX_COURSES] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+GAME_LOCAL char coursetime[MAX_COURSES] = { 10, 15, 10, 20, 10, 10, 10, 5 };
 
 /* =============================================================================
  * Local functions
@@ -796,12 +797,12 @@ void oschool(void)
 #define BANKLIMIT 1000000
 
 /* last time he was in bank */
-static long lasttime = 0;
+static GAME_LOCAL long lasttime = 0;
 
 /* the reference to screen location for each gem */
-static short gemorder[IVENSIZE] = { 0 };
+static GAME_LOCAL short gemorder[IVENSIZE] = { 0 };
 /* the appraisal of the gems */
-static long gemvalue[IVENSIZE] = { 0 };
+static GAME_LOCAL long gemvalue[IVENSIZE] = { 0 };
 
 /* =============================================================================
  * Local functions
@@ -4,7 +4,7 @@
  *
  * DESCRIPTION:
  * This is the main module for ularn.
- * It contains the setup and main processing loop.
+ * It contains the setup, command processing and the game turn processing.
  *
  * =============================================================================
  * EXPORTED VARIABLES
@@ -14,7 +14,9 @@
  * =============================================================================
  * EXPORTED FUNCTIONS
  *
- * None.
+ * ULarnSetup : Perform once off initialisation and start the game
+ * parse      : Execute a command entered by the player
+ * game_turn  : Process one turn of the game
  *
  * =============================================================================
  */
@@ -25,9 +27,11 @@
 
 #include "patchlevel.h"
 
+#include "ularn.h"
 #include "ularn_game.h"
 #include "ularn_win.h"
 #include "ularn_ask.h"
+#include "ularn_script.h"
 #include "getopt.h"
 #include "savegame.h"
 #include "scores.h"
@@ -45,18 +49,13 @@
 #include "help.h"
 #include "diag.h"
 #include "itm.h"
-
-#ifdef WINDOWS
-# include <windows.h>
-#endif
+#include "profile.h"
+#include "vclock.h"
 
 /* =============================================================================
  * Local variables
  */
 
-#define BUFSZ   256 /* for getlin buffers */
-#define MAX_CMDLINE_PARAM 255
-
 static char copyright[] =
   "\nVLarn by Jeffrey H. Johnson <trnsz@pobox.com>\n"
   "  Ularn created by Phil Cordier -- based on Larn by Noah Morgan\n"
@@ -64,7 +63,8 @@ static char copyright[] =
   "  Rewrite and Windows32/X11/Amiga graphics conversion by Julian Olds";
 
 static char cmdhelp[] = "\
-Cmd line format: vlarn [-sicnh] [-o <optsfile>] [-d #] [-r]\n\
+Cmd line format: vlarn [-sicnhP] [-o <optsfile>] [-d #] [-r] [-a <script>]\n\
+                       [-S <seed>] [-R <trace>] [-T <scale>]\n\
   -s   show the scoreboard\n\
   -i   show the scoreboard with inventories\n\
   -c   create new scoreboard (wizard only)\n\
@@ -72,92 +72,23 @@ Cmd line format: vlarn [-sicnh] [-o <optsfile>] [-d #] [-r]\n\
   -h   display this help message\n\
   -o <optsfile> specify options file to be used instead of \"~/vlarn.opt\"\n\
   -d # specify level of difficulty (example: vlarn -d 5)\n\
-  -r   restore checkpoint (vlarn.ckp) file\n";
-
-static char *optstring = "sicnhro:d:";
-
-static short viewflag;
-
-/* =============================================================================
- * Local functions
- */
+  -r   restore checkpoint (vlarn.ckp) file\n\
+  -a <script> read actions from the script file (\"-\" for stdin)\n\
+  -S <seed> start the game from a fixed random number seed\n\
+  -R <trace> record a trace of the game for replay with -a\n\
+  -T <scale> scale time delays by this factor (0 for no delays)\n\
+  -P   profile the game turns and report the times at the end of the game\n";
 
-#ifdef WINDOWS
+static char *optstring = "sicnhPro:d:a:S:R:T:";
 
-/*
- * Windows programs don't use standard command line arguments, so provide
- * a function to convert the windows command line to argc, argv.
- */
+static GAME_LOCAL short viewflag;
 
 /* =============================================================================
- * FUNCTION: _get_cmd_arg
- *
- * DESCRIPTION:
- * Function to help process the windows command line into argc, argv
- * format.
- *
- * PARAMETERS:
- *
- *   pCmdLine : The command line.
- *
- * RETURN VALUE:
- *
- *   The next word on the command line.
+ * Exported functions
  */
-static char* _get_cmd_arg(char* pCmdLine)
-{
-  static char* pArgs = NULL;
-  char  *pRetArg;
-
-  if ((pCmdLine == NULL) && (pArgs == NULL)) return NULL;
-  if (pArgs == NULL) pArgs = pCmdLine;
-
-  /* skip whitespace */
-  for (pRetArg = pArgs; (*pRetArg != 0) && isspace(*pRetArg); pRetArg++);
-  {
-  	if (*pRetArg == 0) {
-  		/* Hit end of string, so return */
-  		pArgs = NULL;
-  		return NULL;
-  	}
-  }
-
-  /* check for quote */
-  if ( *pRetArg == '"' ) {
-  	pRetArg++;
-  	pArgs = strchr(pRetArg, '"');
-  }else
-  	/* skip to whitespace */
-  	for (pArgs = pRetArg; (*pArgs != 0) && !isspace(*pArgs); pArgs++);
-
-  if ((pArgs != NULL) && (*pArgs != 0) ) {
-  	char* p;
-  	p = pArgs;
-  	pArgs++;
-  	*p = 0;
-  }else
-  	pArgs = NULL;
-
-  return pRetArg;
-}
-
-#endif
 
 /* =============================================================================
  * FUNCTION: ULarnSetup
- *
- * DESCRIPTION:
- * Perform once off initialisation and parse the command parameters.
- *
- * PARAMETERS:
- *
- *   argc : The command line argumant count
- *
- *   argv : The command line arguments.
- *
- * RETURN VALUE:
- *
- *   None.
  */
 void ULarnSetup(int argc, char *argv[])
 {
@@ -169,6 +100,9 @@ void ULarnSetup(int argc, char *argv[])
   int show_scores;
   char buf[BUFSIZ];
   char *home;
+  char *tracefile;
+  char *scriptfile;
+  unsigned long seed;
 
   /* clear the loginname and logname */
   loginname[0] = 0;
@@ -209,6 +143,9 @@ void ULarnSetup(int argc, char *argv[])
 
   /* set the initial clock and initialise the random number generator*/
   newgame();
+  seed = (unsigned long)initialtime;
+  tracefile = NULL;
+  scriptfile = NULL;
   hard = -1;
   restore_ckp = 0;
   set_optfile = 0;
@@ -272,6 +209,33 @@ void ULarnSetup(int argc, char *argv[])
   		restore_ckp = 1;
   		break;
 
+  	case 'S':
+  		/* seed the random number generator */
+  		seed = strtoul(optarg, NULL, 0);
+  		rng_seed(seed);
+  		break;
+
+  	case 'R':
+  		/* record a game trace */
+  		tracefile = optarg;
+  		break;
+
+  	case 'T':
+  		/* scale the time delays */
+  		vclock_set_mode((atof(optarg) > 0.0) ? VCLOCK_SCALED : VCLOCK_VIRTUAL,
+  		                atof(optarg));
+  		break;
+
+  	case 'P':
+  		/* profile the game turns */
+  		profile_enable();
+  		break;
+
+  	case 'a':
+  		/* replay an action script */
+  		scriptfile = optarg;
+  		break;
+
   	default:
   		if (!opterr)
   			Printf("Unknown option <%s>\n",
@@ -288,7 +252,6 @@ void ULarnSetup(int argc, char *argv[])
   	}       /* end switch */
   }               /* end while */
 
-
   /* Options filename was not specified on the command line, so set default */
   if (!set_optfile) {
   	sprintf(buf, "%s/%s", home, optsfile);
@@ -298,6 +261,21 @@ void ULarnSetup(int argc, char *argv[])
   /* read the options file if there is one */
   read_options();
 
+  /* open the action script after the options, as a trace has its own */
+  if ((scriptfile != NULL) && !script_open(scriptfile)) {
+  	Printf("Cannot open action script %s\n", scriptfile);
+  	endgame();
+  }
+
+  /*
+   * start recording before any input for the game is read, but after the
+   * options the trace holds have been set
+   */
+  if ((tracefile != NULL) && !script_record(tracefile, seed)) {
+  	Printf("Cannot create game trace %s\n", tracefile);
+  	endgame();
+  }
+
   /*
    * Process scorefile initialisation
    */
@@ -395,8 +373,11 @@ void ULarnSetup(int argc, char *argv[])
   	/* make the dungeon */
   	newcavelevel(0);
 
-  	if (nowelcome == 0)
-  		/* welcome the player to the game */
+  	/*
+  	 * welcome the player to the game, except in game traces as
+  	 * whether it is shown depends on the options file
+  	 */
+  	if ((nowelcome == 0) && !script_trace())
   		welcome();
   }
 
@@ -414,17 +395,6 @@ void ULarnSetup(int argc, char *argv[])
 
 /* =============================================================================
  * FUNCTION: parse
- *
- * DESCRIPTION:
- * Execute a command entered by the player.
- *
- * PARAMETERS:
- *
- *   Action : The action command requested.
- *
- * RETURN VALUE:
- *
- *   None.
  */
 void parse(ActionType Action)
 {
@@ -438,6 +408,13 @@ void parse(ActionType Action)
   	yrepcount = 0;
   	return;
 
+  case ACTION_PROFILE:
+  	if (wizard)
+  		profile_show();
+  	yrepcount = 0;
+  	nomove = 1;
+  	return;
+
   case ACTION_MOVE_WEST:
   	moveplayer(4);
   	return;
@@ -751,9 +728,7 @@ void parse(ActionType Action)
   		j++;
   	}
 
-  	for (i = 0; i < MAXY; i++)
-  		for (j = 0; j < MAXX; j++)
-  			know[j][i] = item[j][i];
+  	memcpy(know, item, LEVEL_CHARS);
 
   	c[GOLD] += 250000;
 
@@ -827,204 +802,67 @@ void parse(ActionType Action)
   }
 }
 
-#ifdef WINDOWS
-
-/* windows uses WinMain instead of main */
-
 /* =============================================================================
- * FUNCTION: WinMain
- *
- * DESCRIPTION:
- * Windows main entry point.
- *
- * PARAMETERS:
- *
- *   hinstance     : This isntance of the application
- *
- *   hprevinstance : The previous instance of the application (if any)
- *
- *   lpcmdline     : The command line
- *
- *   ncmdshow      : The initial state for the application window
- *
- * RETURN VALUE:
- *
- *   Exit status of the application.
- *     0 => normal exit.
+ * FUNCTION: game_turn
  */
-int WINAPI WinMain(
-  HINSTANCE hinstance,
-  HINSTANCE hprevinstance,
-  LPSTR lpcmdline,
-  int ncmdshow)
-
-#else
-
-/* =============================================================================
- * FUNCTION: main
- *
- * DESCRIPTION:
- * Main entry point.
- *
- * PARAMETERS:
- *
- *   argc : Command line argument count
- *
- *   argv : Command line argument strings
- *
- * RETURN VALUE:
- *
- *   Exit status of the application.
- *     0 => normal exit.
- */
-int main(int argc, char *argv[])
-
-#endif
-
+ActionType game_turn(void)
 {
   ActionType Action;
 
-#ifdef WINDOWS
-
-  int argc;
-  char* argv[MAX_CMDLINE_PARAM];
-  TCHAR *p;
-  TCHAR wbuf[BUFSZ];
-  char buf[BUFSZ];
-  size_t len;
-
-#endif
-
-#ifdef AMIGA_WIN
-  int StartedFromWB = 0;
-  char *fake_argv[1] = { "ularn" };
-#endif
-
-
-#ifdef UNIX_X11
-
-  init_app(getenv("DISPLAY"));
-
-#else
-
-# ifdef WINDOWS
-
-  /*
-   * get command line parameters
-   */
-  p = _get_cmd_arg(GetCommandLine());
-  p = _get_cmd_arg(NULL); /* skip first paramter - command name */
-  for (argc = 1; p && argc < MAX_CMDLINE_PARAM; argc++ ) {
-  	len = strlen(p);
-  	if ( len > 0 )
-  		argv[argc] = strdup(p);
-  	else
-  		argv[argc] = "";
-
-  	p = _get_cmd_arg(NULL);
+  if (dropflag == 0) {
+  	profile_begin(PROFILE_LOOKFOROBJECT);
+  	lookforobject();        /* see if there is an object here*/
+  	profile_end();
+  }else {
+  	dropflag = 0;           /* don't show it just dropped an item */
   }
-  GetModuleFileName(NULL, wbuf, BUFSZ);
-  argv[0] = strdup(strncpy(wbuf, buf, BUFSZ));
-
-  //
-  // Setup the display interface
-  //
-
-  if (!init_app(hinstance))
-  	return 0;
-
-# else
 
-#  ifdef AMIGA_WIN
+  if (hitflag == 0) {
+  	profile_begin(PROFILE_MOVEMONST);
+  	if (c[HASTEMONST]) movemonst();
 
-  /* The Amiga sets argc to 0 if the program was started from Workbench
-   * In this case the arg list points to a WBStartup structure instead
-   * of and array of arguments.
-   */
-  if (argc == 0)
-  	StartedFromWB = 1;
-
-  if (!init_app()) {
-  	close_app();
-  	return 0;
+  	movemonst();
+  	profile_end();
   }
 
-#  else
-
-  init_app();
-
-#  endif
-
-# endif
-
-#endif
-
-#ifdef AMIGA_WIN
-
-  if (!StartedFromWB)
-  	ULarnSetup(argc, argv);
-  else
-  	/* fake parameters */
-  	ULarnSetup(1, fake_argv);
-
-#else
-
-  ULarnSetup(argc, argv);
-
-#endif
-
-  /* Everything should be common from here on */
-
-  do{
-  	if (dropflag == 0) {
-  		lookforobject();        /* see if there is an object here*/
-  	}else {
-  		dropflag = 0;           /* don't show it just dropped an item */
-  	}
-
-  	if (hitflag == 0) {
-  		if (c[HASTEMONST]) movemonst();
-
-  		movemonst();
-  	}
-
-  	if (viewflag == 0)
-  		showcell(playerx, playery);
-  	else{
-  		viewflag = 0; /* show stuff around player */
-  	}
+  if (viewflag == 0) {
+  	profile_begin(PROFILE_SHOWCELL);
+  	showcell(playerx, playery);
+  	profile_end();
+  }else{
+  	viewflag = 0; /* show stuff around player */
+  }
 
-  	hitflag = 0;
-  	hit3flag = 0;
+  hitflag = 0;
+  hit3flag = 0;
 
-  	nomove = 1;
+  nomove = 1;
 
-  	/*  get commands and make moves */
-  	while (nomove) {
-  		nomove = 0;
-  		Action = get_normal_input();
-  		parse(Action); /* may reset nomove=1 */
-  	}
-
-  	/* regenerate hp and spells */
-  	regen();
+  /*  get commands and make moves */
+  while (nomove) {
+  	nomove = 0;
+  	Action = get_normal_input();
+  	profile_begin(PROFILE_PARSE);
+  	parse(Action); /* may reset nomove=1 */
+  	profile_end();
+  }
 
-  	if (c[TIMESTOP] == 0) {
-  		rmst--;
-  		if (rmst <= 0) {
-  			rmst = (char)(120 - (level << 2));
-  			fillmonst(makemonst(level));
-  		}
+  /* regenerate hp and spells */
+  profile_begin(PROFILE_REGEN);
+  regen();
+  profile_end();
+
+  if (c[TIMESTOP] == 0) {
+  	rmst--;
+  	if (rmst <= 0) {
+  		rmst = (char)(120 - (level << 2));
+  		profile_begin(PROFILE_SPAWN);
+  		fillmonst(makemonst(level));
+  		profile_end();
   	}
+  }
 
-  } while (Action != ACTION_QUIT);
-
-  /*
-   * tidyup and exit
-   */
-  endgame();
-
-  /* not actually reachable */
-  return 0;
+  profile_turn();
 
+  return Action;
 }
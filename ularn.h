@@ -0,0 +1,86 @@
+/* =============================================================================
+ * PROGRAM:  ularn
+ * FILENAME: ularn.h
+ *
+ * DESCRIPTION:
+ * This is the main module for ularn.
+ * It contains the setup, command processing and the game turn processing.
+ * The program entry point is in ularn_main.c, so that other programs can
+ * run the game by calling these functions directly.
+ *
+ * =============================================================================
+ * EXPORTED VARIABLES
+ *
+ * None.
+ *
+ * =============================================================================
+ * EXPORTED FUNCTIONS
+ *
+ * ULarnSetup : Perform once off initialisation and start the game
+ * parse      : Execute a command entered by the player
+ * game_turn  : Process one turn of the game
+ *
+ * =============================================================================
+ */
+
+#ifndef __ULARN_H
+# define __ULARN_H
+
+# include "ularn_win.h"
+
+/* =============================================================================
+ * FUNCTION: ULarnSetup
+ *
+ * DESCRIPTION:
+ * Perform once off initialisation and parse the command parameters.
+ * On return a new or restored game is ready to play.
+ *
+ * PARAMETERS:
+ *
+ *   argc : The command line argumant count
+ *
+ *   argv : The command line arguments.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+void ULarnSetup(int argc, char *argv[]);
+
+/* =============================================================================
+ * FUNCTION: parse
+ *
+ * DESCRIPTION:
+ * Execute a command entered by the player.
+ *
+ * PARAMETERS:
+ *
+ *   Action : The action command requested.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+void parse(ActionType Action);
+
+/* =============================================================================
+ * FUNCTION: game_turn
+ *
+ * DESCRIPTION:
+ * Process one turn of the game.
+ * This looks for objects at the player's location, moves the monsters, gets
+ * and executes player commands until one takes a move, then regenerates the
+ * player and creates new monsters as required.
+ * If the game ends during the turn then this function does not return.
+ *
+ * PARAMETERS:
+ *
+ *   None.
+ *
+ * RETURN VALUE:
+ *
+ *   The last action executed.
+ */
+ActionType game_turn(void);
+
+#endif
@@ -36,7 +36,7 @@
  */
 
 /* the current line number for paginating text */
-static int srcount = 0;
+static GAME_LOCAL int srcount = 0;
 
 /* =============================================================================
  * Exported functions
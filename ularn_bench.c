@@ -0,0 +1,696 @@
+/* =============================================================================
+ * PROGRAM:  ularn
+ * FILENAME: ularn_bench.c
+ *
+ * DESCRIPTION:
+ * This module is the program entry point for vlarn-bench, the micro-benchmark
+ * suite.
+ * It times the known hot routines of the game in isolation, starting each
+ * benchmark from a fixed random number seed, and prints one line per
+ * benchmark:
+ *
+ *   <name> <ns/op> <ops/sec> <ops>
+ *
+ * Lines starting with '#' are comments, so the output can be compared from
+ * release to release with standard tools.
+ *
+ * With -k, the movemonst benchmarks are run instead on a level holding a
+ * growing number of aggravated monsters, from 10 up to as many as the level
+ * can hold, giving the scaling curve of the monster movement code:
+ *
+ *   <name>_k<monsters> <ns/op> <ops/sec> <ops>
+ *   <name>_kfull <ns/op> <ops/sec> <ops>
+ *
+ * where each op is one turn of movemonst. The monsters are scattered over
+ * the level at random, so only some of them are in the movement window round
+ * the player, where smart monsters look up to 40 steps for a path.
+ *
+ * Each benchmark runs on a new thread so that it starts from the initial
+ * game state. Work that is needed to repeat an operation but is not part of
+ * it (such as restoring the level that monsters have moved on) is done
+ * between timed batches.
+ *
+ * =============================================================================
+ * EXPORTED VARIABLES
+ *
+ * None.
+ *
+ * =============================================================================
+ * EXPORTED FUNCTIONS
+ *
+ * main : The program entry point
+ *
+ * =============================================================================
+ */
+
+#include <pthread.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "config.h"
+#include "digest.h"
+#include "header.h"
+#include "getopt.h"
+#include "ularn_game.h"
+#include "ularn_win.h"
+#include "dungeon.h"
+#include "fortune.h"
+#include "itm.h"
+#include "monster.h"
+#include "player.h"
+#include "rng.h"
+#include "savegame.h"
+#include "scores.h"
+#include "scroll.h"
+#include "sphere.h"
+
+/* =============================================================================
+ * Local variables
+ */
+
+static char cmdhelp[] = "\
+Cmd line format: vlarn-bench [-hkp] [-S <seed>] [-t <seconds>] [name ...]\n\
+  -h   display this help message\n\
+  -k   run the movemonst benchmarks with 10 up to a full level of monsters\n\
+  -p   pack the levels the player isn't on\n\
+  -S <seed> random number seed for each benchmark (default 1)\n\
+  -t <seconds> minimum time to run each benchmark (default 0.5)\n\
+  name run only the named benchmarks\n";
+
+static char *optstring = "hkpS:t:";
+
+/*
+ * The dungeon level used for the level based benchmarks
+ */
+#define BENCH_LEVEL 10
+
+/*
+ * A benchmark.
+ * Setup is called once before timing starts. Reset, if not NULL, is called
+ * before each timed batch of Batch operations.
+ */
+struct Benchmark {
+  char *Name;
+  void (*Setup)(void);
+  void (*Reset)(void);
+  void (*Op)(void);
+  int Batch;
+  double Time;  /* The total time of the timed batches (seconds) */
+  long Ops;     /* The number of operations timed */
+  int Selected; /* Set if the benchmark is to be run */
+  int Died;     /* Set if the game ended during the benchmark */
+};
+
+static unsigned long Seed = 1;
+static double MinTime = 0.5;
+
+/*
+ * The monster counts for the -k scaling curve. SCALE_FULL fills the level.
+ * ScaleMonsters is the count for the benchmark being run (0 to leave the
+ * level as made), and ScalePlaced is the number of monsters it placed.
+ */
+#define SCALE_FULL (MAXX * MAXY)
+
+static int ScaleCounts[] = {10, 20, 50, 100, 200, 400, 800, SCALE_FULL};
+
+#define NUM_SCALE_COUNTS ((int)(sizeof(ScaleCounts) / sizeof(ScaleCounts[0])))
+
+static int ScaleMonsters = 0;
+static int ScalePlaced = 0;
+
+/*
+ * The save file used by the savegame and restoregame benchmarks
+ */
+static char BenchFile[MAXPATHLEN + 32];
+
+/*
+ * The benchmark running on this thread, and where to go if the game ends
+ */
+static GAME_LOCAL struct Benchmark *Current;
+static GAME_LOCAL jmp_buf GameOverJump;
+
+/*
+ * The player and level state restored between movemonst batches
+ */
+static GAME_LOCAL int BenchX;
+static GAME_LOCAL int BenchY;
+static GAME_LOCAL int BenchLevel;
+
+/*
+ * The copy of the level restored between movemonst batches.
+ * savelevel doesn't copy the level, as the level arrays are its storage.
+ */
+static GAME_LOCAL char BenchItem[MAXX][MAXY];
+static GAME_LOCAL char BenchKnow[MAXX][MAXY];
+static GAME_LOCAL short BenchHitp[MAXX][MAXY];
+static GAME_LOCAL short BenchIarg[MAXX][MAXY];
+static GAME_LOCAL struct_mitem BenchMitem[MAXX][MAXY];
+static GAME_LOCAL Stolen_Table BenchStolen;
+
+/* =============================================================================
+ * Local functions
+ */
+
+/* =============================================================================
+ * FUNCTION: bench_clock
+ *
+ * DESCRIPTION:
+ * Get a monotonic time in seconds.
+ *
+ * PARAMETERS:
+ *
+ *   None.
+ *
+ * RETURN VALUE:
+ *
+ *   The current time in seconds.
+ */
+static double bench_clock(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1.0e9;
+}
+
+/* =============================================================================
+ * FUNCTION: game_over
+ *
+ * DESCRIPTION:
+ * Called if the game ends during a benchmark. The benchmark is abandoned.
+ *
+ * PARAMETERS:
+ *
+ *   Reason  : How the game ended
+ *
+ *   Monster : The monster involved in the player's death (if any)
+ *
+ * RETURN VALUE:
+ *
+ *   This function does not return.
+ */
+static void game_over(DiedReasonType Reason, int Monster) {
+  (void)Reason;
+  (void)Monster;
+
+  longjmp(GameOverJump, 1);
+}
+
+/* =============================================================================
+ * FUNCTION: new_game
+ *
+ * DESCRIPTION:
+ * Set up a new game on the home level, as ULarnSetup does.
+ *
+ * PARAMETERS:
+ *
+ *   None.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+static void new_game(void) {
+  strcpy(loginname, "bench");
+  strcpy(logname, "bench");
+
+  init_cells();
+  newgame();
+  rng_seed(Seed);
+  makeplayer();
+  newcavelevel(0);
+  set_display(DISPLAY_MAP);
+}
+
+/* =============================================================================
+ * Benchmark functions
+ */
+
+/*
+ * movemonst with all monsters using smart_move or all using dumb_move.
+ * All monsters on the level are moved (as when aggravated), and the player
+ * has enough hit points to survive a batch.
+ * For the scaling curve, the monsters on the level are replaced by
+ * ScaleMonsters monsters of the kinds found on the level.
+ */
+static void fill_monsters(int Monsters) {
+  int x, y;
+
+  for (x = 0; x < MAXX; x++)
+    for (y = 0; y < MAXY; y++)
+      mitem[x][y].mon = MONST_NONE;
+  roster_rebuild();
+
+  ScalePlaced = 0;
+  while ((ScalePlaced < Monsters) && (fillmonst(makemonst(level)) != -1))
+    ScalePlaced++;
+}
+
+static void setup_movemonst(void) {
+  newcavelevel(BENCH_LEVEL);
+  positionplayer();
+
+  if (ScaleMonsters > 0)
+    fill_monsters(ScaleMonsters);
+
+  BenchX = playerx;
+  BenchY = playery;
+  BenchLevel = level;
+
+  memcpy(BenchItem, item, sizeof(BenchItem));
+  memcpy(BenchKnow, know, sizeof(BenchKnow));
+  memcpy(BenchHitp, hitp, sizeof(BenchHitp));
+  memcpy(BenchIarg, iarg, sizeof(BenchIarg));
+  memcpy(BenchMitem, mitem, sizeof(BenchMitem));
+  stolen_copy(&BenchStolen, stolen);
+}
+
+static void set_intelligence(int Intelligence) {
+  int i;
+
+  for (i = 0; i < MONST_COUNT; i++)
+    monster[i].intelligence = (char)Intelligence;
+
+  reset_move_policy();
+}
+
+static void setup_smart_move(void) {
+  set_intelligence(127);
+  setup_movemonst();
+}
+
+static void setup_dumb_move(void) {
+  set_intelligence(0);
+  setup_movemonst();
+}
+
+static void reset_movemonst(void) {
+  level = (char)BenchLevel;
+  getlevel();
+
+  memcpy(item, BenchItem, sizeof(BenchItem));
+  memcpy(know, BenchKnow, sizeof(BenchKnow));
+  memcpy(hitp, BenchHitp, sizeof(BenchHitp));
+  memcpy(iarg, BenchIarg, sizeof(BenchIarg));
+  memcpy(mitem, BenchMitem, sizeof(BenchMitem));
+  stolen_copy(stolen, &BenchStolen);
+  roster_rebuild();
+
+  playerx = (char)BenchX;
+  playery = (char)BenchY;
+
+  c[AGGRAVATE] = 1000;
+  c[HPMAX] = (ScaleMonsters > 0) ? 10000000 : 30000;
+  c[HP] = c[HPMAX];
+}
+
+static void op_movemonst(void) { movemonst(); }
+
+/*
+ * newcavelevel, making a new dungeon level (including makemaze and eat)
+ * each time.
+ */
+static void op_newcavelevel(void) {
+  int lev;
+
+  lev = (level % (DBOTTOM - 1)) + 1;
+  beenhere[lev] = 0;
+  newcavelevel(lev);
+}
+
+/*
+ * eat, carving the maze for a new level
+ */
+static void reset_eat(void) {
+  int x, y;
+
+  for (y = 0; y < MAXY; y++)
+    for (x = 0; x < MAXX; x++)
+      item[x][y] = OWALL;
+}
+
+static void op_eat(void) { eat(1, 1); }
+
+/*
+ * AnalyseWalls for a whole level
+ */
+static void setup_level(void) { newcavelevel(BENCH_LEVEL); }
+
+static void op_analysewalls(void) { AnalyseWalls(0, 0, MAXX - 1, MAXY - 1); }
+
+/*
+ * Full level sweeps: the magic mapping scroll and the monster healing scroll
+ */
+static void op_magicmap(void) { read_scroll(SMAGICMAP); }
+
+static void op_monsterheal(void) { read_scroll(SMONSTHEAL); }
+
+/*
+ * savelevel and getlevel: the level checksum and switching the level arrays
+ */
+static void op_savelevel(void) { savelevel(); }
+
+static void setup_getlevel(void) {
+  newcavelevel(BENCH_LEVEL);
+  savelevel();
+}
+
+static void op_getlevel(void) { getlevel(); }
+
+/*
+ * newcavelevel between levels that have been visited, as when the player
+ * takes the stairs: the current level is saved and the next one restored.
+ */
+static void setup_levelchange(void) {
+  newcavelevel(BENCH_LEVEL);
+  newcavelevel(BENCH_LEVEL + 1);
+}
+
+static void op_levelchange(void) {
+  newcavelevel((level == BENCH_LEVEL) ? BENCH_LEVEL + 1 : BENCH_LEVEL);
+}
+
+/*
+ * savegame and restoregame with all levels visited
+ */
+static void setup_all_levels(void) {
+  int lev;
+
+  for (lev = 1; lev < NLEVELS; lev++)
+    newcavelevel(lev);
+
+  newcavelevel(0);
+}
+
+static void op_savegame(void) { savegame(BenchFile); }
+
+static void reset_restoregame(void) {
+  savegame(BenchFile);
+
+  /* restoregame allocates new level storage */
+  free_cells();
+}
+
+static void op_restoregame(void) { restoregame(BenchFile); }
+
+/*
+ * fortune, after the fortune file has been read
+ */
+static void setup_fortune(void) { fortune(fortfile); }
+
+static void op_fortune(void) { fortune(fortfile); }
+
+/*
+ * digest_state after the monsters have moved, and digest_game with all
+ * levels visited
+ */
+static void reset_digest_state(void) {
+  reset_movemonst();
+  movemonst();
+}
+
+static void op_digest_state(void) { digest_state(); }
+
+static void op_digest_game(void) { digest_game(); }
+
+/*
+ * sortboard
+ */
+static void op_sortboard(void) { sortboard(); }
+
+/*
+ * The benchmarks
+ */
+static struct Benchmark Benchmarks[] = {
+    {"movemonst_smart", setup_smart_move, reset_movemonst, op_movemonst, 100,
+     0.0, 0, 1, 0},
+    {"movemonst_dumb", setup_dumb_move, reset_movemonst, op_movemonst, 100, 0.0,
+     0, 1, 0},
+    {"newcavelevel", NULL, NULL, op_newcavelevel, 1, 0.0, 0, 1, 0},
+    {"eat", NULL, reset_eat, op_eat, 1, 0.0, 0, 1, 0},
+    {"analysewalls", setup_level, NULL, op_analysewalls, 100, 0.0, 0, 1, 0},
+    {"magicmap", setup_level, NULL, op_magicmap, 100, 0.0, 0, 1, 0},
+    {"monsterheal", setup_level, NULL, op_monsterheal, 100, 0.0, 0, 1, 0},
+    {"savelevel", setup_level, NULL, op_savelevel, 100, 0.0, 0, 1, 0},
+    {"getlevel", setup_getlevel, NULL, op_getlevel, 100, 0.0, 0, 1, 0},
+    {"levelchange", setup_levelchange, NULL, op_levelchange, 100, 0.0, 0, 1,
+     0},
+    {"savegame", setup_all_levels, NULL, op_savegame, 1, 0.0, 0, 1, 0},
+    {"restoregame", setup_all_levels, reset_restoregame, op_restoregame, 1, 0.0,
+     0, 1, 0},
+    {"digest_state", setup_movemonst, reset_digest_state, op_digest_state, 1,
+     0.0, 0, 1, 0},
+    {"digest_game", setup_all_levels, NULL, op_digest_game, 100, 0.0, 0, 1, 0},
+    {"fortune", setup_fortune, NULL, op_fortune, 1000, 0.0, 0, 1, 0},
+    {"sortboard", NULL, NULL, op_sortboard, 100, 0.0, 0, 1, 0}};
+
+#define NUM_BENCHMARKS ((int)(sizeof(Benchmarks) / sizeof(Benchmarks[0])))
+
+/* =============================================================================
+ * FUNCTION: run_benchmark
+ *
+ * DESCRIPTION:
+ * Thread function to run one benchmark.
+ *
+ * PARAMETERS:
+ *
+ *   arg : The Benchmark to run.
+ *
+ * RETURN VALUE:
+ *
+ *   NULL.
+ */
+static void *run_benchmark(void *arg) {
+  double start;
+  int i;
+
+  Current = (struct Benchmark *)arg;
+
+  set_game_over(game_over);
+
+  if (setjmp(GameOverJump) != 0) {
+    Current->Died = 1;
+    return NULL;
+  }
+
+  new_game();
+  if (Current->Setup != NULL)
+    Current->Setup();
+
+  Current->Time = 0.0;
+  Current->Ops = 0;
+
+  while (Current->Time < MinTime) {
+    if (Current->Reset != NULL)
+      Current->Reset();
+
+    start = bench_clock();
+    for (i = 0; i < Current->Batch; i++)
+      Current->Op();
+    Current->Time += bench_clock() - start;
+
+    Current->Ops += Current->Batch;
+  }
+
+  stolen_free(&BenchStolen);
+  free_cells();
+  free_spheres();
+  free_fortunes();
+
+  return NULL;
+}
+
+/* =============================================================================
+ * FUNCTION: run_on_thread
+ *
+ * DESCRIPTION:
+ * Run one benchmark on a new thread.
+ *
+ * PARAMETERS:
+ *
+ *   Bench : The benchmark to run.
+ *
+ * RETURN VALUE:
+ *
+ *   0 if the thread could not be created, otherwise 1.
+ */
+static int run_on_thread(struct Benchmark *Bench) {
+  pthread_t thread;
+
+  if (pthread_create(&thread, NULL, run_benchmark, Bench) != 0) {
+    fprintf(stderr, "Cannot create a thread for %s\n", Bench->Name);
+    return 0;
+  }
+  pthread_join(thread, NULL);
+
+  return 1;
+}
+
+/* =============================================================================
+ * FUNCTION: print_result
+ *
+ * DESCRIPTION:
+ * Print the result of a benchmark.
+ *
+ * PARAMETERS:
+ *
+ *   Bench : The benchmark that was run.
+ *
+ *   Name  : The name to print for the result.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+static void print_result(struct Benchmark *Bench, char *Name) {
+  if (Bench->Died || (Bench->Ops == 0))
+    printf("# %s failed: the game ended\n", Name);
+  else
+    printf("%s %.1f %.1f %ld\n", Name,
+           Bench->Time * 1.0e9 / (double)Bench->Ops,
+           (double)Bench->Ops / Bench->Time, Bench->Ops);
+  fflush(stdout);
+}
+
+/* =============================================================================
+ * FUNCTION: run_scaling
+ *
+ * DESCRIPTION:
+ * Run a movemonst benchmark for each monster count in the scaling curve.
+ * The curve stops once the level is full.
+ *
+ * PARAMETERS:
+ *
+ *   Bench : The benchmark to run.
+ *
+ * RETURN VALUE:
+ *
+ *   0 if a thread could not be created, otherwise 1.
+ */
+static int run_scaling(struct Benchmark *Bench) {
+  char Name[80];
+  int i;
+
+  for (i = 0; i < NUM_SCALE_COUNTS; i++) {
+    ScaleMonsters = ScaleCounts[i];
+
+    if (!run_on_thread(Bench))
+      return 0;
+
+    if (ScalePlaced < ScaleMonsters) {
+      sprintf(Name, "%s_kfull", Bench->Name);
+      printf("# %s: the level is full at %d monsters\n", Name, ScalePlaced);
+    } else
+      sprintf(Name, "%s_k%d", Bench->Name, ScaleMonsters);
+
+    print_result(Bench, Name);
+
+    if (ScalePlaced < ScaleMonsters)
+      break;
+  }
+
+  ScaleMonsters = 0;
+
+  return 1;
+}
+
+/* =============================================================================
+ * Exported functions
+ */
+
+/* =============================================================================
+ * FUNCTION: main
+ */
+int main(int argc, char *argv[]) {
+  struct Benchmark *Bench;
+  int Scaling = 0;
+  int i, j;
+
+  opterr = 0;
+  while ((i = ugetopt(argc, argv, optstring)) != -1) {
+    switch (i) {
+    case 'k':
+      Scaling = 1;
+      break;
+
+    case 'p':
+      pack_levels = 1;
+      break;
+
+    case 'S':
+      Seed = strtoul(optarg, NULL, 0);
+      break;
+
+    case 't':
+      MinTime = atof(optarg);
+      break;
+
+    default:
+      fprintf(stderr, "%s", cmdhelp);
+      return (i == 'h') ? 0 : 1;
+    }
+  }
+
+  //
+  // Select the named benchmarks, if any
+  //
+  if (optind < argc) {
+    for (j = 0; j < NUM_BENCHMARKS; j++)
+      Benchmarks[j].Selected = 0;
+
+    for (i = optind; i < argc; i++) {
+      for (j = 0; j < NUM_BENCHMARKS; j++)
+        if (strcmp(argv[i], Benchmarks[j].Name) == 0)
+          break;
+
+      if (j == NUM_BENCHMARKS) {
+        fprintf(stderr, "Unknown benchmark %s\n", argv[i]);
+        return 1;
+      }
+      Benchmarks[j].Selected = 1;
+    }
+  }
+
+  //
+  // Game options shared by all benchmarks
+  //
+  nonap = 1;
+  ckpflag = 0;
+  nowelcome = 1;
+  sprintf(larnlevels, "%s/%s", libdir, LEVELSNAME);
+  sprintf(fortfile, "%s/%s", libdir, FORTSNAME);
+  sprintf(BenchFile, "%s/vlarn-bench-%d.sav", P_tmpdir, (int)getpid());
+
+  printf("# vlarn-bench seed %lu, min time %.2f s\n", Seed, MinTime);
+  printf("# name ns/op ops/sec ops\n");
+
+  for (j = 0; j < NUM_BENCHMARKS; j++) {
+    Bench = &Benchmarks[j];
+    if (!Bench->Selected)
+      continue;
+
+    if (Scaling) {
+      //
+      // Only the movemonst benchmarks have a monster count
+      //
+      if (Bench->Reset != reset_movemonst)
+        continue;
+
+      if (!run_scaling(Bench))
+        return 1;
+    } else {
+      if (!run_on_thread(Bench))
+        return 1;
+
+      print_result(Bench, Bench->Name);
+    }
+  }
+
+  unlink(BenchFile);
+
+  return 0;
+}
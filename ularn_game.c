@@ -17,6 +17,8 @@
  * mail           : True if mail bills when game is won
  * ckpflag        : True if checkpoint files are to be used.
  * nobeep         : True if beep is off.
+ * catchup        : True if levels catch up on the time the player was away
+ * pack_levels    : True if levels the player isn't on are kept packed
  * libdir         : VLarn library path
  * savedir        : Directroy for save games
  * savefilename   : Filename for saving the game
@@ -69,13 +71,15 @@ char boldon = 1;  /* 1=bold objects,  0=inverse objects */
 char mail = 1;    /* 1=mail letters after win game */
 char ckpflag = 1; /* 1 if want checkpointing of game, 0 otherwise */
 char nobeep = 0;  /* true if program is not to beep*/
+char catchup = 0; /* 1 if levels catch up on time away, 0 otherwise */
+char pack_levels = 0; /* 1 if levels not being played are packed */
 
 char libdir[MAXPATHLEN] = LIBDIR;
 
 char savedir[MAXPATHLEN];
 
 /* the game save filename   */
-char savefilename[MAXPATHLEN + 255];
+GAME_LOCAL char savefilename[MAXPATHLEN + 255];
 
 /* the temporary save filename   */
 char tempfilename[MAXPATHLEN + 32];
@@ -96,7 +100,7 @@ char fortfile[MAXPATHLEN + 16];
 char optsfile[MAXPATHLEN + 16] = "vlarn.opt";
 
 /* the checkpoint file filename */
-char ckpfile[MAXPATHLEN + 16] = "vlarn.ckp";
+GAME_LOCAL char ckpfile[MAXPATHLEN + 16] = "vlarn.ckp";
 
 /* the diagnostic filename  */
 char diagfile[] = "diagfile.txt";
@@ -104,14 +108,14 @@ char diagfile[] = "diagfile.txt";
 /* the wizard's password */
 char *password = "rodney";
 
-int userid;                          /* the players login user id number */
-char loginname[USERNAME_LENGTH + 1]; /* players login name */
-char logname[LOGNAMESIZE + 1];       /* players name storage for scoring */
+GAME_LOCAL int userid;                          /* the players login user id number */
+GAME_LOCAL char loginname[USERNAME_LENGTH + 1]; /* players login name */
+GAME_LOCAL char logname[LOGNAMESIZE + 1];       /* players name storage for scoring */
 
 char nowelcome = 0;         /* if nowelcome, don't display welcome message */
-char nomove = 0;            /* if nomove no count next iteration as move   */
-char dropflag = 0;          /* if 1 then don't lookforobject() next round */
-char restorflag = 0;        /* 1 means restore has been done */
+GAME_LOCAL char nomove = 0;            /* if nomove no count next iteration as move   */
+GAME_LOCAL char dropflag = 0;          /* if 1 then don't lookforobject() next round */
+GAME_LOCAL char restorflag = 0;        /* 1 means restore has been done */
 char enhance_interface = 0; /* 1 means use the enhanced command interface */
 
 char diroffx[] = {0, 0, 1, 0, -1, 1, -1, 1, -1};
@@ -140,6 +144,11 @@ typedef enum {
   OPTION_NOENHANCE_INT,
   OPTION_BEEP,
   OPTION_NOBEEP,
+  OPTION_ROAM,
+  OPTION_CATCHUP,
+  OPTION_NOCATCHUP,
+  OPTION_PACKLEVELS,
+  OPTION_NOPACKLEVELS,
   OPTION_COUNT
 } OptionType;
 
@@ -154,7 +163,12 @@ static char *OptionString[OPTION_COUNT] = {"",
                                            "enhanced_interface",
                                            "noenhanced_interface",
                                            "beep",
-                                           "nobeep"};
+                                           "nobeep",
+                                           "roam",
+                                           "catchup",
+                                           "nocatchup",
+                                           "packlevels",
+                                           "nopacklevels"};
 
 /* =============================================================================
  * Exported functions
@@ -165,7 +179,7 @@ static char *OptionString[OPTION_COUNT] = {"",
  */
 void newgame(void) {
   time(&initialtime);
-  srand((unsigned)initialtime);
+  rng_seed((unsigned long)initialtime);
 }
 
 /* =============================================================================
@@ -311,6 +325,28 @@ void read_options(void) {
             nobeep = 1;
             break;
 
+          case OPTION_ROAM:
+            tok = strtok(NULL, ":,\n");
+            if (tok != NULL)
+              roam_budget = atoi(tok);
+            break;
+
+          case OPTION_CATCHUP:
+            catchup = 1;
+            break;
+
+          case OPTION_NOCATCHUP:
+            catchup = 0;
+            break;
+
+          case OPTION_PACKLEVELS:
+            pack_levels = 1;
+            break;
+
+          case OPTION_NOPACKLEVELS:
+            pack_levels = 0;
+            break;
+
           default:
             Printf("\nUnrecognised option '%s'", tok);
             break;
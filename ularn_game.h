@@ -17,6 +17,8 @@
  * mail           : True if mail bills when game is won
  * ckpflag        : True if checkpoint files are to be used.
  * nobeep         : True if beep is off.
+ * catchup        : True if levels catch up on the time the player was away
+ * pack_levels    : True if levels the player isn't on are kept packed
  * libdir         : Ularn library path
  * savedir        : Directroy for save games
  * savefilename   : Filename for saving the game
@@ -53,6 +55,8 @@
 #ifndef __ULARN_GAME_H
 # define __ULARN_GAME_H
 
+# include "config.h"
+
 /* =============================================================================
  * Exported variables
  */
@@ -65,6 +69,8 @@ extern char boldon;  /* 1=bold objects,  0=inverse objects */
 extern char mail;    /* 1=mail letters after win game */
 extern char ckpflag; /* 1 if want checkpointing of game, 0 otherwise */
 extern char nobeep;  /* true if program is not to beep*/
+extern char catchup; /* 1 if levels catch up on time away, 0 otherwise */
+extern char pack_levels; /* 1 if levels not being played are packed */
 
 /* *************** File Names *************** */
 
@@ -95,7 +101,7 @@ extern char libdir[MAXPATHLEN];
 extern char savedir[MAXPATHLEN];
 
 /* the game save filename   */
-extern char savefilename[MAXPATHLEN + 255];
+extern GAME_LOCAL char savefilename[MAXPATHLEN + 255];
 
 /* the score file       */
 extern char scorefile[MAXPATHLEN + 16];
@@ -113,7 +119,7 @@ extern char fortfile[MAXPATHLEN + 16];
 extern char optsfile[MAXPATHLEN + 16];
 
 /* the checkpoint file filename */
-extern char ckpfile[MAXPATHLEN + 16];
+extern GAME_LOCAL char ckpfile[MAXPATHLEN + 16];
 
 /* the diagnostic filename  */
 extern char diagfile[MAXPATHLEN];
@@ -121,14 +127,14 @@ extern char diagfile[MAXPATHLEN];
 /* the wizard's password */
 extern char *password;
 
-extern int userid; /* the players login user id number */
-extern char loginname[USERNAME_LENGTH + 1]; /* players login name */
-extern char logname[LOGNAMESIZE + 1]; /* players name storage for scoring */
+extern GAME_LOCAL int userid; /* the players login user id number */
+extern GAME_LOCAL char loginname[USERNAME_LENGTH + 1]; /* players login name */
+extern GAME_LOCAL char logname[LOGNAMESIZE + 1]; /* players name storage for scoring */
 
 extern char nowelcome;         /* if nowelcome, don't display welcome message */
-extern char nomove;            /* if nomove no count next iteration as move   */
-extern char dropflag;          /* if 1 then don't lookforobject() next round */
-extern char restorflag;        /* 1 means restore has been done */
+extern GAME_LOCAL char nomove;            /* if nomove no count next iteration as move   */
+extern GAME_LOCAL char dropflag;          /* if 1 then don't lookforobject() next round */
+extern GAME_LOCAL char restorflag;        /* 1 means restore has been done */
 extern char enhance_interface; /* 1 means use the enhanced command interface */
 
 /*
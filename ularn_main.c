@@ -1,11 +1,272 @@
+/* =============================================================================
+ * PROGRAM:  ularn
+ * FILENAME: ularn_main.c
+ *
+ * DESCRIPTION:
+ * This module contains the program entry point for ularn.
+ * It initialises the display, sets up the game and runs the game turns
+ * until the player quits.
+ *
+ * =============================================================================
+ * EXPORTED VARIABLES
+ *
+ * None.
+ *
+ * =============================================================================
+ * EXPORTED FUNCTIONS
+ *
+ * main : The program entry point (WinMain for Windows)
+ *
+ * =============================================================================
+ */
+
+#include <ctype.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
+#include "ularn.h"
 #include "ularn_win.h"
+#include "scores.h"
+
+#ifdef WINDOWS
+# include <windows.h>
+#endif
+
+/* =============================================================================
+ * Local variables
+ */
+
+#define BUFSZ   256 /* for getlin buffers */
+#define MAX_CMDLINE_PARAM 255
+
+/* =============================================================================
+ * Local functions
+ */
+
+#ifdef WINDOWS
+
+/*
+ * Windows programs don't use standard command line arguments, so provide
+ * a function to convert the windows command line to argc, argv.
+ */
+
+/* =============================================================================
+ * FUNCTION: _get_cmd_arg
+ *
+ * DESCRIPTION:
+ * Function to help process the windows command line into argc, argv
+ * format.
+ *
+ * PARAMETERS:
+ *
+ *   pCmdLine : The command line.
+ *
+ * RETURN VALUE:
+ *
+ *   The next word on the command line.
+ */
+static char* _get_cmd_arg(char* pCmdLine)
+{
+  static char* pArgs = NULL;
+  char  *pRetArg;
+
+  if ((pCmdLine == NULL) && (pArgs == NULL)) return NULL;
+  if (pArgs == NULL) pArgs = pCmdLine;
+
+  /* skip whitespace */
+  for (pRetArg = pArgs; (*pRetArg != 0) && isspace(*pRetArg); pRetArg++);
+  {
+  	if (*pRetArg == 0) {
+  		/* Hit end of string, so return */
+  		pArgs = NULL;
+  		return NULL;
+  	}
+  }
+
+  /* check for quote */
+  if ( *pRetArg == '"' ) {
+  	pRetArg++;
+  	pArgs = strchr(pRetArg, '"');
+  }else
+  	/* skip to whitespace */
+  	for (pArgs = pRetArg; (*pArgs != 0) && !isspace(*pArgs); pArgs++);
+
+  if ((pArgs != NULL) && (*pArgs != 0) ) {
+  	char* p;
+  	p = pArgs;
+  	pArgs++;
+  	*p = 0;
+  }else
+  	pArgs = NULL;
+
+  return pRetArg;
+}
+
+#endif
+
+/* =============================================================================
+ * Exported functions
+ */
+
+#ifdef WINDOWS
+
+/* windows uses WinMain instead of main */
+
+/* =============================================================================
+ * FUNCTION: WinMain
+ *
+ * DESCRIPTION:
+ * Windows main entry point.
+ *
+ * PARAMETERS:
+ *
+ *   hinstance     : This isntance of the application
+ *
+ *   hprevinstance : The previous instance of the application (if any)
+ *
+ *   lpcmdline     : The command line
+ *
+ *   ncmdshow      : The initial state for the application window
+ *
+ * RETURN VALUE:
+ *
+ *   Exit status of the application.
+ *     0 => normal exit.
+ */
+int WINAPI WinMain(
+  HINSTANCE hinstance,
+  HINSTANCE hprevinstance,
+  LPSTR lpcmdline,
+  int ncmdshow)
+
+#else
+
+/* =============================================================================
+ * FUNCTION: main
+ *
+ * DESCRIPTION:
+ * Main entry point.
+ *
+ * PARAMETERS:
+ *
+ *   argc : Command line argument count
+ *
+ *   argv : Command line argument strings
+ *
+ * RETURN VALUE:
+ *
+ *   Exit status of the application.
+ *     0 => normal exit.
+ */
+int main(int argc, char *argv[])
+
+#endif
+
+{
+  ActionType Action;
+
+#ifdef WINDOWS
+
+  int argc;
+  char* argv[MAX_CMDLINE_PARAM];
+  TCHAR *p;
+  TCHAR wbuf[BUFSZ];
+  char buf[BUFSZ];
+  size_t len;
+
+#endif
 
-int main(int argc, char *argv[]) {
-  InitApp(":0");
+#ifdef AMIGA_WIN
+  int StartedFromWB = 0;
+  char *fake_argv[1] = { "ularn" };
+#endif
 
-  CloseApp();
 
+#ifdef UNIX_X11
+
+  init_app(getenv("DISPLAY"));
+
+#else
+
+# ifdef WINDOWS
+
+  /*
+   * get command line parameters
+   */
+  p = _get_cmd_arg(GetCommandLine());
+  p = _get_cmd_arg(NULL); /* skip first paramter - command name */
+  for (argc = 1; p && argc < MAX_CMDLINE_PARAM; argc++ ) {
+  	len = strlen(p);
+  	if ( len > 0 )
+  		argv[argc] = strdup(p);
+  	else
+  		argv[argc] = "";
+
+  	p = _get_cmd_arg(NULL);
+  }
+  GetModuleFileName(NULL, wbuf, BUFSZ);
+  argv[0] = strdup(strncpy(wbuf, buf, BUFSZ));
+
+  //
+  // Setup the display interface
+  //
+
+  if (!init_app(hinstance))
+  	return 0;
+
+# else
+
+#  ifdef AMIGA_WIN
+
+  /* The Amiga sets argc to 0 if the program was started from Workbench
+   * In this case the arg list points to a WBStartup structure instead
+   * of and array of arguments.
+   */
+  if (argc == 0)
+  	StartedFromWB = 1;
+
+  if (!init_app()) {
+  	close_app();
+  	return 0;
+  }
+
+#  else
+
+  init_app();
+
+#  endif
+
+# endif
+
+#endif
+
+#ifdef AMIGA_WIN
+
+  if (!StartedFromWB)
+  	ULarnSetup(argc, argv);
+  else
+  	/* fake parameters */
+  	ULarnSetup(1, fake_argv);
+
+#else
+
+  ULarnSetup(argc, argv);
+
+#endif
+
+  /* Everything should be common from here on */
+
+  do{
+  	Action = game_turn();
+  } while (Action != ACTION_QUIT);
+
+  /*
+   * tidyup and exit
+   */
+  endgame();
+
+  /* not actually reachable */
   return 0;
+
 }
@@ -0,0 +1,793 @@
+/* =============================================================================
+ * PROGRAM:  ularn
+ * FILENAME: ularn_script.c
+ *
+ * DESCRIPTION:
+ * This module provides a scripted input source for the display modules.
+ * When an action script is open, commands, prompt answers, directions and
+ * numbers are read from the script instead of the keyboard, and time delays
+ * are skipped, so games can be replayed as fast as the game logic allows.
+ *
+ * =============================================================================
+ * EXPORTED VARIABLES
+ *
+ * None
+ *
+ * =============================================================================
+ * EXPORTED FUNCTIONS
+ *
+ * script_open            : Open an action script
+ * script_close           : Close the action script and report the replay rate
+ * script_record          : Start recording a game trace
+ * script_trace           : Check if a game trace is being recorded or replayed
+ * script_game_over       : Take the game state digest at the end of the game
+ * script_active          : Check if input is being read from a script
+ * script_action          : Get the next command action from the script
+ * script_answer          : Get the next prompt answer from the script
+ * script_number          : Get the next number from the script
+ * script_password        : Get the next password from the script
+ * script_record_action   : Record a command action in the trace
+ * script_record_answer   : Record a prompt answer in the trace
+ * script_record_number   : Record a number in the trace
+ * script_record_password : Record a password in the trace
+ *
+ * =============================================================================
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "digest.h"
+#include "header.h"
+#include "monster.h"
+#include "player.h"
+#include "rng.h"
+#include "ularn_game.h"
+#include "ularn_script.h"
+#include "ularn_win.h"
+
+/* =============================================================================
+ * Local variables
+ */
+
+/*
+ * Action names.
+ * The strings must match the order of the ActionType enumeration
+ */
+static char *ActionName[ACTION_COUNT] = {
+    "NULL",           "DIAG",           "MOVE_WEST",      "RUN_WEST",
+    "MOVE_EAST",      "RUN_EAST",       "MOVE_SOUTH",     "RUN_SOUTH",
+    "MOVE_NORTH",     "RUN_NORTH",      "MOVE_NORTHEAST", "RUN_NORTHEAST",
+    "MOVE_NORTHWEST", "RUN_NORTHWEST",  "MOVE_SOUTHEAST", "RUN_SOUTHEAST",
+    "MOVE_SOUTHWEST", "RUN_SOUTHWEST",  "WAIT",           "NONE",
+    "WIELD",          "WEAR",           "READ",           "QUAFF",
+    "DROP",           "CAST_SPELL",     "OPEN_DOOR",      "CLOSE_DOOR",
+    "OPEN_CHEST",     "INVENTORY",      "EAT_COOKIE",     "LIST_SPELLS",
+    "HELP",           "SAVE",           "TELEPORT",       "IDENTIFY_TRAPS",
+    "BECOME_CREATOR", "CREATE_ITEM",    "TOGGLE_WIZARD",  "DEBUG_MODE",
+    "REMOVE_ARMOUR",  "PACK_WEIGHT",    "VERSION",        "QUIT",
+    "REDRAW_SCREEN",  "SHOW_TAX",       "PROFILE"};
+
+/*
+ * Script token types
+ */
+typedef enum TokenType {
+  TOKEN_NONE,
+  TOKEN_ACTION,
+  TOKEN_NUMBER,
+  TOKEN_CHAR,
+  TOKEN_STRING,
+  TOKEN_DEFAULT,
+  TOKEN_SEED,
+  TOKEN_SETTING
+} TokenType;
+
+/*
+ * The game settings held in a trace, which would otherwise come from the
+ * options file.
+ * The names must match the order of the SettingType enumeration.
+ */
+typedef enum SettingType {
+  SETTING_NAME,
+  SETTING_CLASS,
+  SETTING_GENDER,
+  SETTING_ROAM,
+  SETTING_CATCHUP,
+  SETTING_PACKLEVELS,
+  SETTING_COUNT
+} SettingType;
+
+static char *SettingName[SETTING_COUNT] = {
+    "NAME", "CLASS", "GENDER", "ROAM", "CATCHUP", "PACKLEVELS"};
+
+#define MAX_TOKEN_LENGTH 80
+
+static FILE *ScriptFile = NULL;
+static int ScriptLine;
+static int ScriptUsed = 0;
+
+static TokenType Token;
+static int TokenValue;
+static char TokenText[MAX_TOKEN_LENGTH + 1];
+static int TokenPending = 0;
+
+/*
+ * Game trace recording and checking
+ */
+static FILE *RecordFile = NULL;
+static int Recorded = 0;
+static int ScriptTrace = 0;
+static int HaveDigest = 0;
+static DigestType TraceDigest;
+static int GameOver = 0;
+static DigestType GameDigest;
+static int UnusedTokens;
+
+/*
+ * Replay statistics
+ */
+static long ActionCount;
+static long StartTime;
+static double StartClock;
+static double EndClock;
+
+/* =============================================================================
+ * Local functions
+ */
+
+/* =============================================================================
+ * FUNCTION: script_clock
+ *
+ * DESCRIPTION:
+ * Get a monotonic time in seconds for measuring the replay rate.
+ *
+ * PARAMETERS:
+ *
+ *   None.
+ *
+ * RETURN VALUE:
+ *
+ *   The current time in seconds.
+ */
+static double script_clock(void) {
+#ifdef UNIX
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1.0e9;
+#else
+  return (double)clock() / (double)CLOCKS_PER_SEC;
+#endif
+}
+
+/* =============================================================================
+ * FUNCTION: end_script
+ *
+ * DESCRIPTION:
+ * Stop reading from the script and record the end time of the replay.
+ *
+ * PARAMETERS:
+ *
+ *   None.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+static void end_script(void) {
+  if (ScriptFile == NULL)
+    return;
+
+  EndClock = script_clock();
+
+  if (ScriptFile != stdin)
+    fclose(ScriptFile);
+  ScriptFile = NULL;
+}
+
+/* =============================================================================
+ * FUNCTION: bad_token
+ *
+ * DESCRIPTION:
+ * Report a token that doesn't fit the input requested and stop the script.
+ *
+ * PARAMETERS:
+ *
+ *   expected : A description of the input requested.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+static void bad_token(char *expected) {
+  fprintf(stderr, "Action script line %d: expected %s, got '%s'\n",
+          ScriptLine, expected, TokenText);
+  end_script();
+}
+
+/* =============================================================================
+ * FUNCTION: read_escape
+ *
+ * DESCRIPTION:
+ * Read a character from the script, decoding a backslash escape.
+ *
+ * PARAMETERS:
+ *
+ *   escaped : Set if the character was escaped, so it is to be taken
+ *             literally even if it is a quote.
+ *
+ * RETURN VALUE:
+ *
+ *   The character read, or EOF.
+ */
+static int read_escape(int *escaped) {
+  int ch;
+
+  *escaped = 0;
+
+  ch = fgetc(ScriptFile);
+  if (ch != '\\')
+    return ch;
+
+  ch = fgetc(ScriptFile);
+  if (ch == EOF)
+    return ch;
+
+  *escaped = 1;
+  switch (ch) {
+  case 'e':
+    return ESC;
+  case 'r':
+  case 'n':
+    return '\015';
+  case 'b':
+    return '\010';
+  default:
+    return ch;
+  }
+}
+
+/* =============================================================================
+ * FUNCTION: next_token
+ *
+ * DESCRIPTION:
+ * Read the next token from the script into Token, TokenValue and TokenText.
+ * At the end of the script Token is set to TOKEN_NONE and the script is
+ * closed.
+ *
+ * PARAMETERS:
+ *
+ *   None.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+static void next_token(void) {
+  int ch;
+  int escaped;
+  int len;
+  int i;
+  char *name;
+
+  if (TokenPending) {
+    TokenPending = 0;
+    return;
+  }
+
+  Token = TOKEN_NONE;
+  TokenText[0] = 0;
+
+  //
+  // Skip white space and comments
+  //
+  do {
+    ch = fgetc(ScriptFile);
+    if (ch == '#') {
+      while ((ch != '\n') && (ch != EOF))
+        ch = fgetc(ScriptFile);
+    }
+    if (ch == '\n')
+      ScriptLine++;
+  } while ((ch != EOF) && isspace(ch));
+
+  if (ch == EOF) {
+    end_script();
+    return;
+  }
+
+  len = 0;
+
+  if (ch == '\'') {
+    //
+    // A single character answer
+    //
+    TokenValue = read_escape(&escaped);
+    ch = fgetc(ScriptFile);
+    sprintf(TokenText, "'%c'", TokenValue);
+    Token = (ch == '\'') ? TOKEN_CHAR : TOKEN_NONE;
+    return;
+  }
+
+  if (ch == '"') {
+    //
+    // A string answer
+    //
+    ch = read_escape(&escaped);
+    while (escaped || ((ch != '"') && (ch != EOF) && (ch != '\n'))) {
+      if (len < MAX_TOKEN_LENGTH)
+        TokenText[len++] = (char)ch;
+      ch = read_escape(&escaped);
+    }
+    TokenText[len] = 0;
+    Token = (ch == '"') ? TOKEN_STRING : TOKEN_NONE;
+    return;
+  }
+
+  while ((ch != EOF) && !isspace(ch)) {
+    if (len < MAX_TOKEN_LENGTH)
+      TokenText[len++] = (char)ch;
+    ch = fgetc(ScriptFile);
+  }
+  TokenText[len] = 0;
+  if (ch == '\n')
+    ungetc(ch, ScriptFile);
+
+  if (strcmp(TokenText, "*") == 0) {
+    Token = TOKEN_DEFAULT;
+    return;
+  }
+
+  if (isdigit((unsigned char)TokenText[0]) ||
+      ((TokenText[0] == '-') && isdigit((unsigned char)TokenText[1]))) {
+    Token = TOKEN_NUMBER;
+    TokenValue = atoi(TokenText);
+    return;
+  }
+
+  if (strcmp(TokenText, "SEED") == 0) {
+    Token = TOKEN_SEED;
+    return;
+  }
+
+  for (i = 0; i < SETTING_COUNT; i++) {
+    if (strcmp(TokenText, SettingName[i]) == 0) {
+      Token = TOKEN_SETTING;
+      TokenValue = i;
+      return;
+    }
+  }
+
+  if (strcmp(TokenText, "DIGEST") == 0) {
+    //
+    // The game state digest ends a trace
+    //
+    next_token();
+    TraceDigest = strtoull(TokenText, &name, 16);
+    HaveDigest = (TokenText[0] != 0) && (*name == 0);
+    end_script();
+    Token = TOKEN_NONE;
+    return;
+  }
+
+  name = TokenText;
+  if (strncmp(name, "ACTION_", 7) == 0)
+    name += 7;
+
+  for (i = 0; i < ACTION_COUNT; i++) {
+    if (strcmp(name, ActionName[i]) == 0) {
+      Token = TOKEN_ACTION;
+      TokenValue = i;
+      return;
+    }
+  }
+}
+
+/* =============================================================================
+ * FUNCTION: read_setting
+ *
+ * DESCRIPTION:
+ * Read the value of a game setting from a trace and apply it.
+ *
+ * PARAMETERS:
+ *
+ *   Setting : The setting to read.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+static void read_setting(SettingType Setting) {
+  next_token();
+
+  if (ScriptFile == NULL)
+    return;
+
+  if (Setting == SETTING_NAME) {
+    if (Token != TOKEN_STRING) {
+      bad_token("a name");
+      return;
+    }
+
+    strncpy(logname, TokenText, LOGNAMESIZE);
+    logname[LOGNAMESIZE] = 0;
+    return;
+  }
+
+  if (Token != TOKEN_NUMBER) {
+    bad_token("a number");
+    return;
+  }
+
+  switch (Setting) {
+  case SETTING_CLASS:
+    char_picked = (char)TokenValue;
+    break;
+  case SETTING_GENDER:
+    sex = (char)TokenValue;
+    break;
+  case SETTING_ROAM:
+    roam_budget = TokenValue;
+    break;
+  case SETTING_CATCHUP:
+    catchup = (char)TokenValue;
+    break;
+  case SETTING_PACKLEVELS:
+    pack_levels = (char)TokenValue;
+    break;
+  default:
+    break;
+  }
+}
+
+/* =============================================================================
+ * FUNCTION: record_string
+ *
+ * DESCRIPTION:
+ * Write a quoted string to the trace, escaping quotes and backslashes.
+ *
+ * PARAMETERS:
+ *
+ *   str : The string to write.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+static void record_string(char *str) {
+  char *p;
+
+  fprintf(RecordFile, " \"");
+  for (p = str; *p != 0; p++) {
+    if ((*p == '"') || (*p == '\\'))
+      fputc('\\', RecordFile);
+    fputc(*p, RecordFile);
+  }
+  fprintf(RecordFile, "\"");
+}
+
+/* =============================================================================
+ * Exported functions
+ */
+
+/* =============================================================================
+ * FUNCTION: script_open
+ */
+int script_open(char *filename) {
+  end_script();
+
+  if (strcmp(filename, "-") == 0)
+    ScriptFile = stdin;
+  else
+    ScriptFile = fopen(filename, "r");
+
+  if (ScriptFile == NULL)
+    return 0;
+
+  ScriptLine = 1;
+  ScriptUsed = 1;
+  ScriptTrace = 0;
+  HaveDigest = 0;
+  TokenPending = 0;
+
+  //
+  // A trace starts with the seed and the settings for the game
+  //
+  next_token();
+  if (Token == TOKEN_SEED) {
+    next_token();
+    rng_seed(strtoul(TokenText, NULL, 0));
+    ScriptTrace = 1;
+
+    next_token();
+    while ((ScriptFile != NULL) && (Token == TOKEN_SETTING)) {
+      read_setting((SettingType)TokenValue);
+      next_token();
+    }
+  }
+  TokenPending = 1;
+
+  ActionCount = 0;
+  StartTime = gtime;
+  StartClock = script_clock();
+  EndClock = StartClock;
+
+  return 1;
+}
+
+/* =============================================================================
+ * FUNCTION: script_close
+ */
+int script_close(void) {
+  double elapsed;
+  int match;
+
+  match = 1;
+
+  if (Recorded) {
+    fprintf(stderr, "Trace recorded: digest %016llx\n", GameDigest);
+    Recorded = 0;
+  }
+
+  if (!ScriptUsed)
+    return match;
+
+  end_script();
+  ScriptUsed = 0;
+
+  elapsed = EndClock - StartClock;
+
+  fprintf(stderr, "Action script: %ld actions, %ld turns in %.3f s", ActionCount,
+          gtime - StartTime, elapsed);
+  if (elapsed > 0.0)
+    fprintf(stderr, " (%.0f actions/sec, %.0f turns/sec)",
+            (double)ActionCount / elapsed,
+            (double)(gtime - StartTime) / elapsed);
+  fprintf(stderr, "\n");
+
+  if (ScriptTrace) {
+    if (UnusedTokens > 0)
+      fprintf(stderr, "Trace: %d inputs not used\n", UnusedTokens);
+
+    if (!GameOver || !HaveDigest) {
+      fprintf(stderr, "Trace: no digest to check\n");
+      match = 0;
+    } else if (GameDigest != TraceDigest) {
+      fprintf(stderr, "Trace: digest MISMATCH, expected %016llx, got %016llx\n",
+              TraceDigest, GameDigest);
+      match = 0;
+    } else
+      fprintf(stderr, "Trace: digest %016llx matches\n", GameDigest);
+
+    ScriptTrace = 0;
+  }
+
+  return match;
+}
+
+/* =============================================================================
+ * FUNCTION: script_record
+ */
+int script_record(char *filename, unsigned long seed) {
+  if (RecordFile != NULL)
+    fclose(RecordFile);
+
+  RecordFile = fopen(filename, "w");
+  if (RecordFile == NULL)
+    return 0;
+
+  fprintf(RecordFile, "# vlarn game trace\nSEED %lu\n", seed);
+
+  fprintf(RecordFile, "%s", SettingName[SETTING_NAME]);
+  record_string(logname);
+  fprintf(RecordFile, "\n%s %d\n", SettingName[SETTING_CLASS], char_picked);
+  fprintf(RecordFile, "%s %d\n", SettingName[SETTING_GENDER], sex);
+  fprintf(RecordFile, "%s %d\n", SettingName[SETTING_ROAM], roam_budget);
+  fprintf(RecordFile, "%s %d\n", SettingName[SETTING_CATCHUP], catchup);
+  fprintf(RecordFile, "%s %d\n", SettingName[SETTING_PACKLEVELS],
+          pack_levels);
+
+  return 1;
+}
+
+/* =============================================================================
+ * FUNCTION: script_trace
+ */
+int script_trace(void) { return ScriptTrace || (RecordFile != NULL); }
+
+/* =============================================================================
+ * FUNCTION: script_game_over
+ */
+void script_game_over(void) {
+  if (!script_trace())
+    return;
+
+  GameDigest = digest_game();
+  GameOver = 1;
+
+  if (RecordFile != NULL) {
+    fprintf(RecordFile, "\nDIGEST %016llx\n", GameDigest);
+    fclose(RecordFile);
+    RecordFile = NULL;
+    Recorded = 1;
+  }
+
+  //
+  // Read on to the digest at the end of the trace. Any inputs left mean the
+  // replay has not followed the recorded game.
+  //
+  UnusedTokens = 0;
+  while (ScriptTrace && (ScriptFile != NULL)) {
+    next_token();
+    if (ScriptFile != NULL)
+      UnusedTokens++;
+  }
+}
+
+/* =============================================================================
+ * FUNCTION: script_active
+ */
+int script_active(void) { return (ScriptFile != NULL); }
+
+/* =============================================================================
+ * FUNCTION: script_action
+ */
+int script_action(ActionType *Action) {
+  if (ScriptFile == NULL)
+    return 0;
+
+  next_token();
+
+  if (ScriptFile == NULL)
+    return 0;
+
+  if (((Token != TOKEN_ACTION) && (Token != TOKEN_NUMBER)) ||
+      (TokenValue <= ACTION_NULL) || (TokenValue >= ACTION_COUNT)) {
+    bad_token("an action");
+    return 0;
+  }
+
+  //
+  // Count turns from the first command, as a restored game starts part way
+  // through
+  //
+  if (ActionCount == 0)
+    StartTime = gtime;
+
+  ActionCount++;
+  *Action = (ActionType)TokenValue;
+
+  return 1;
+}
+
+/* =============================================================================
+ * FUNCTION: script_answer
+ */
+int script_answer(char *answers, char *ch) {
+  if (ScriptFile == NULL)
+    return 0;
+
+  next_token();
+
+  if (ScriptFile == NULL)
+    return 0;
+
+  if ((Token != TOKEN_CHAR) || (TokenValue == 0) ||
+      (strchr(answers, TokenValue) == NULL)) {
+    bad_token("a prompt answer");
+    return 0;
+  }
+
+  *ch = (char)TokenValue;
+
+  return 1;
+}
+
+/* =============================================================================
+ * FUNCTION: script_number
+ */
+int script_number(int defval, int *value) {
+  if (ScriptFile == NULL)
+    return 0;
+
+  next_token();
+
+  if (ScriptFile == NULL)
+    return 0;
+
+  if (Token == TOKEN_DEFAULT)
+    *value = defval;
+  else if (Token == TOKEN_NUMBER)
+    *value = TokenValue;
+  else {
+    bad_token("a number");
+    return 0;
+  }
+
+  return 1;
+}
+
+/* =============================================================================
+ * FUNCTION: script_password
+ */
+int script_password(char *password, int Len) {
+  if (ScriptFile == NULL)
+    return 0;
+
+  next_token();
+
+  if (ScriptFile == NULL)
+    return 0;
+
+  if (Token != TOKEN_STRING) {
+    bad_token("a password");
+    return 0;
+  }
+
+  strncpy(password, TokenText, Len);
+  password[Len] = 0;
+
+  return 1;
+}
+
+/* =============================================================================
+ * FUNCTION: script_record_action
+ */
+void script_record_action(ActionType Action) {
+  if ((RecordFile == NULL) || (Action <= ACTION_NULL) ||
+      (Action >= ACTION_COUNT))
+    return;
+
+  fprintf(RecordFile, "\n%s", ActionName[Action]);
+}
+
+/* =============================================================================
+ * FUNCTION: script_record_answer
+ */
+void script_record_answer(char ch) {
+  if (RecordFile == NULL)
+    return;
+
+  switch (ch) {
+  case ESC:
+    fprintf(RecordFile, " '\\e'");
+    break;
+  case '\015':
+    fprintf(RecordFile, " '\\r'");
+    break;
+  case '\010':
+    fprintf(RecordFile, " '\\b'");
+    break;
+  case '\'':
+  case '\\':
+    fprintf(RecordFile, " '\\%c'", ch);
+    break;
+  default:
+    fprintf(RecordFile, " '%c'", ch);
+    break;
+  }
+}
+
+/* =============================================================================
+ * FUNCTION: script_record_number
+ */
+void script_record_number(int value) {
+  if (RecordFile == NULL)
+    return;
+
+  fprintf(RecordFile, " %d", value);
+}
+
+/* =============================================================================
+ * FUNCTION: script_record_password
+ */
+void script_record_password(char *password) {
+  if (RecordFile == NULL)
+    return;
+
+  record_string(password);
+}
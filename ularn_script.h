@@ -0,0 +1,321 @@
+/* =============================================================================
+ * PROGRAM:  ularn
+ * FILENAME: ularn_script.h
+ *
+ * DESCRIPTION:
+ * This module provides a scripted input source for the display modules.
+ * When an action script is open, commands, prompt answers, directions and
+ * numbers are read from the script instead of the keyboard, and time delays
+ * are skipped, so games can be replayed as fast as the game logic allows.
+ *
+ * The script is a text file (or pipe) of whitespace separated tokens:
+ *
+ *   MOVE_WEST   An action, named as in ActionType with or without the
+ *               ACTION_ prefix.
+ *   12          A number. This is an ActionType value when a command is
+ *               expected, or the value for a number input.
+ *   'y'         A character answering a prompt. The escapes \e (escape),
+ *               \r (return), \b (backspace), \' and \\ may be used.
+ *   "text"      A string answering a password input. The escapes \" and \\
+ *               may be used.
+ *   *           Accept the default value for a number input.
+ *   # ...       A comment, up to the end of the line.
+ *
+ * When the script ends, or a token does not fit the input requested, the
+ * script is closed and input reverts to the display module's normal source.
+ *
+ * A game trace is a script recorded during play. It starts with the random
+ * number seed and the game settings that would otherwise come from the
+ * options file, and ends with the digest of the game state at the end of the
+ * game:
+ *
+ *   SEED 1234   The seed for the game, applied when the script is opened.
+ *   NAME "text" The player's name.
+ *   CLASS 0     The character class letter picked, or 0 if none.
+ *   GENDER 1    The character's gender (sex).
+ *   ROAM 0      The roam budget for monsters outside the move window.
+ *   CATCHUP 0   1 if levels catch up on the time the player was away.
+ *   PACKLEVELS 0
+ *               1 if levels the player isn't on are kept packed.
+ *               The settings follow SEED and are applied when the script is
+ *               opened, so they override the options file.
+ *   DIGEST 0123456789abcdef
+ *               The game state digest (see digest.h), checked at the end of
+ *               the game. This also ends the script.
+ *
+ * =============================================================================
+ * EXPORTED VARIABLES
+ *
+ * None
+ *
+ * =============================================================================
+ * EXPORTED FUNCTIONS
+ *
+ * script_open            : Open an action script
+ * script_close           : Close the action script and report the replay rate
+ * script_record          : Start recording a game trace
+ * script_trace           : Check if a game trace is being recorded or replayed
+ * script_game_over       : Take the game state digest at the end of the game
+ * script_active          : Check if input is being read from a script
+ * script_action          : Get the next command action from the script
+ * script_answer          : Get the next prompt answer from the script
+ * script_number          : Get the next number from the script
+ * script_password        : Get the next password from the script
+ * script_record_action   : Record a command action in the trace
+ * script_record_answer   : Record a prompt answer in the trace
+ * script_record_number   : Record a number in the trace
+ * script_record_password : Record a password in the trace
+ *
+ * =============================================================================
+ */
+
+#ifndef __ULARN_SCRIPT_H
+# define __ULARN_SCRIPT_H
+
+# include "ularn_win.h"
+
+/* =============================================================================
+ * FUNCTION: script_open
+ *
+ * DESCRIPTION:
+ * Open an action script and start reading input from it.
+ * The seed and settings at the start of a game trace are applied, so this
+ * must be called after the options file is read.
+ *
+ * PARAMETERS:
+ *
+ *   filename : The name of the script file, or "-" to read stdin.
+ *
+ * RETURN VALUE:
+ *
+ *   1 if the script was opened, otherwise 0.
+ */
+int script_open(char *filename);
+
+/* =============================================================================
+ * FUNCTION: script_close
+ *
+ * DESCRIPTION:
+ * Close the action script, if one was used, and print the number of actions
+ * replayed and the replay rate to stderr.
+ * If a game trace was replayed, the result of the digest check is also
+ * printed, and if a trace was recorded its digest is printed.
+ *
+ * PARAMETERS:
+ *
+ *   None.
+ *
+ * RETURN VALUE:
+ *
+ *   0 if a replayed trace did not end in the recorded state, otherwise 1.
+ */
+int script_close(void);
+
+/* =============================================================================
+ * FUNCTION: script_record
+ *
+ * DESCRIPTION:
+ * Start recording a game trace.
+ * The seed and the current game settings are written first, so this must be
+ * called after the options file is read. Every command action, prompt
+ * answer, number and password entered from now on is written to the trace.
+ *
+ * PARAMETERS:
+ *
+ *   filename : The name of the trace file.
+ *
+ *   seed     : The random number seed for the game.
+ *
+ * RETURN VALUE:
+ *
+ *   1 if the trace file was opened, otherwise 0.
+ */
+int script_record(char *filename, unsigned long seed);
+
+/* =============================================================================
+ * FUNCTION: script_trace
+ *
+ * DESCRIPTION:
+ * Check if a game trace is being recorded or replayed.
+ *
+ * PARAMETERS:
+ *
+ *   None.
+ *
+ * RETURN VALUE:
+ *
+ *   1 if a trace is being recorded or replayed, otherwise 0.
+ */
+int script_trace(void);
+
+/* =============================================================================
+ * FUNCTION: script_game_over
+ *
+ * DESCRIPTION:
+ * Take the digest of the game state at the end of the game.
+ * When recording, the digest is written to the end of the trace and the
+ * trace is closed. When replaying a trace, the digest recorded in the trace
+ * is read for checking by script_close.
+ * This must be called before the game state is freed.
+ *
+ * PARAMETERS:
+ *
+ *   None.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+void script_game_over(void);
+
+/* =============================================================================
+ * FUNCTION: script_active
+ *
+ * DESCRIPTION:
+ * Check if input is currently being read from an action script.
+ *
+ * PARAMETERS:
+ *
+ *   None.
+ *
+ * RETURN VALUE:
+ *
+ *   1 if a script is active, otherwise 0.
+ */
+int script_active(void);
+
+/* =============================================================================
+ * FUNCTION: script_action
+ *
+ * DESCRIPTION:
+ * Get the next command action from the script.
+ *
+ * PARAMETERS:
+ *
+ *   Action : This is set to the action read.
+ *
+ * RETURN VALUE:
+ *
+ *   1 if an action was read, or 0 if the script is not active.
+ */
+int script_action(ActionType *Action);
+
+/* =============================================================================
+ * FUNCTION: script_answer
+ *
+ * DESCRIPTION:
+ * Get the next prompt answer from the script.
+ *
+ * PARAMETERS:
+ *
+ *   answers : The set of valid answers.
+ *
+ *   ch      : This is set to the answer read.
+ *
+ * RETURN VALUE:
+ *
+ *   1 if an answer was read, or 0 if the script is not active.
+ */
+int script_answer(char *answers, char *ch);
+
+/* =============================================================================
+ * FUNCTION: script_number
+ *
+ * DESCRIPTION:
+ * Get the next number from the script.
+ *
+ * PARAMETERS:
+ *
+ *   defval : The value to use if the script selects the default.
+ *
+ *   value  : This is set to the number read.
+ *
+ * RETURN VALUE:
+ *
+ *   1 if a number was read, or 0 if the script is not active.
+ */
+int script_number(int defval, int *value);
+
+/* =============================================================================
+ * FUNCTION: script_password
+ *
+ * DESCRIPTION:
+ * Get the next password from the script.
+ *
+ * PARAMETERS:
+ *
+ *   password : The buffer to store the password.
+ *
+ *   Len      : The maximum length of the password.
+ *
+ * RETURN VALUE:
+ *
+ *   1 if a password was read, or 0 if the script is not active.
+ */
+int script_password(char *password, int Len);
+
+/* =============================================================================
+ * FUNCTION: script_record_action
+ *
+ * DESCRIPTION:
+ * Record a command action in the trace, if recording.
+ *
+ * PARAMETERS:
+ *
+ *   Action : The action entered.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+void script_record_action(ActionType Action);
+
+/* =============================================================================
+ * FUNCTION: script_record_answer
+ *
+ * DESCRIPTION:
+ * Record a prompt answer in the trace, if recording.
+ *
+ * PARAMETERS:
+ *
+ *   ch : The answer entered.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+void script_record_answer(char ch);
+
+/* =============================================================================
+ * FUNCTION: script_record_number
+ *
+ * DESCRIPTION:
+ * Record a number in the trace, if recording.
+ *
+ * PARAMETERS:
+ *
+ *   value : The number entered.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+void script_record_number(int value);
+
+/* =============================================================================
+ * FUNCTION: script_record_password
+ *
+ * DESCRIPTION:
+ * Record a password in the trace, if recording.
+ *
+ * PARAMETERS:
+ *
+ *   password : The password entered.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+void script_record_password(char *password);
+
+#endif
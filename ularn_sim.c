@@ -0,0 +1,771 @@
+/* =============================================================================
+ * PROGRAM:  ularn
+ * FILENAME: ularn_sim.c
+ *
+ * DESCRIPTION:
+ * This module is the program entry point for vlarn-sim, the Monte Carlo game
+ * runner.
+ * It plays a number of seeded games with a simple built-in bot, spread over
+ * a pool of worker threads, and reports the games per second and the
+ * distribution of the game results (how each game ended, the deepest level
+ * reached, the game time reached, the final score and the memory used to
+ * store the dungeon levels at the end of the game).
+ *
+ * The game state is thread local, so each game is played on a new thread,
+ * which starts with the initial game state. The headless display module
+ * supplies the bot's input to the game.
+ *
+ * The bot attacks any adjacent monster, rests when badly hurt and otherwise
+ * heads for the dungeon entrance or the stairs down by the shortest path,
+ * wandering randomly when there is no way down. It takes any item it finds
+ * and never uses its inventory.
+ *
+ * =============================================================================
+ * EXPORTED VARIABLES
+ *
+ * None.
+ *
+ * =============================================================================
+ * EXPORTED FUNCTIONS
+ *
+ * main : The program entry point
+ *
+ * =============================================================================
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "config.h"
+#include "digest.h"
+#include "header.h"
+#include "getopt.h"
+#include "ularn.h"
+#include "ularn_game.h"
+#include "ularn_win.h"
+#include "ularn_winnull.h"
+#include "dungeon.h"
+#include "fortune.h"
+#include "itm.h"
+#include "monster.h"
+#include "player.h"
+#include "rng.h"
+#include "scores.h"
+#include "sphere.h"
+
+/* =============================================================================
+ * Local variables
+ */
+
+static char cmdhelp[] = "\
+Cmd line format: vlarn-sim [-hcDp] [-g #] [-j #] [-S <seed>] [-t #] [-d #]\n\
+                           [-r #]\n\
+  -h   display this help message\n\
+  -g # number of games to play (default 1000)\n\
+  -j # number of worker threads (default is one per processor)\n\
+  -S <seed> random number seed for the first game, incremented per game\n\
+  -t # turn limit for each game (default 20000)\n\
+  -d # specify level of difficulty\n\
+  -D   digest the game state every turn, not just at the end of each game\n\
+  -r # monsters outside the move window looked at for roaming each turn\n\
+  -c   levels catch up on the time the player was away\n\
+  -p   pack the levels the player isn't on\n";
+
+static char *optstring = "hcDpg:j:S:t:d:r:";
+
+#define DEFAULT_GAMES 1000
+#define DEFAULT_TURNS 20000
+
+/*
+ * The end of game reason recorded for a game still in progress at the turn
+ * limit.
+ */
+#define SIM_TURN_LIMIT DIED_COUNT
+
+/*
+ * The number of commands the bot may try in one turn without taking a move
+ * before it waits instead.
+ */
+#define BOT_MAX_TRIES 100
+
+/*
+ * The result of one game
+ */
+struct SimResult {
+  unsigned long Seed;    /* The random number seed for the game */
+  DiedReasonType Reason; /* How the game ended */
+  int Deepest;           /* The deepest level visited */
+  long Turns;            /* The game time reached */
+  long Score;            /* The final score */
+  long LevelBytes;       /* The memory used by level storage at the end */
+  DigestType Digest;     /* The digest of the game states */
+};
+
+/*
+ * Simulation parameters
+ */
+static int Games = DEFAULT_GAMES;
+static int Threads = 0;
+static unsigned long BaseSeed = 1;
+static long TurnLimit = DEFAULT_TURNS;
+static int Hardness = -1;
+static int TurnDigests = 0;
+
+/*
+ * The game results, and the index of the next game to be played
+ */
+static struct SimResult *Results;
+static int NextGame = 0;
+static pthread_mutex_t NextGameLock = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * The result for the game being played on this thread
+ */
+static GAME_LOCAL struct SimResult *CurrentResult;
+
+/*
+ * The bot's command count for the current turn
+ */
+static GAME_LOCAL long BotTurn = -1;
+static GAME_LOCAL int BotTries;
+
+/*
+ * The move action for each direction (see diroffx and diroffy)
+ */
+static ActionType DirAction[9] = {
+    ACTION_WAIT,          ACTION_MOVE_SOUTH,     ACTION_MOVE_EAST,
+    ACTION_MOVE_NORTH,    ACTION_MOVE_WEST,      ACTION_MOVE_NORTHEAST,
+    ACTION_MOVE_NORTHWEST, ACTION_MOVE_SOUTHEAST, ACTION_MOVE_SOUTHWEST};
+
+/* =============================================================================
+ * Local functions
+ */
+
+/* =============================================================================
+ * FUNCTION: sim_clock
+ *
+ * DESCRIPTION:
+ * Get a monotonic time in seconds for measuring the simulation rate.
+ *
+ * PARAMETERS:
+ *
+ *   None.
+ *
+ * RETURN VALUE:
+ *
+ *   The current time in seconds.
+ */
+static double sim_clock(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1.0e9;
+}
+
+/* =============================================================================
+ * FUNCTION: bot_passable
+ *
+ * DESCRIPTION:
+ * Check if the bot is willing to walk through a location.
+ *
+ * PARAMETERS:
+ *
+ *   x : The x coordinate of the location
+ *
+ *   y : The y coordinate of the location
+ *
+ * RETURN VALUE:
+ *
+ *   1 if the bot can walk through the location, otherwise 0.
+ */
+static int bot_passable(int x, int y) {
+  if ((x < 0) || (x >= MAXX) || (y < 0) || (y >= MAXY))
+    return 0;
+
+  if (item[x][y] == OWALL)
+    return 0;
+
+  /* don't leave the dungeon by the way in */
+  if ((level == 1) && (x == 33) && (y == MAXY - 1))
+    return 0;
+
+  return 1;
+}
+
+/* =============================================================================
+ * FUNCTION: bot_path
+ *
+ * DESCRIPTION:
+ * Find the first step on the shortest path from the player to the nearest
+ * location containing the specified object.
+ *
+ * PARAMETERS:
+ *
+ *   Goal : The object to find.
+ *
+ * RETURN VALUE:
+ *
+ *   The direction of the first step, or 0 if there is no path.
+ */
+static int bot_path(int Goal) {
+  unsigned char first[MAXX][MAXY];
+  short queue[MAXX * MAXY];
+  int head, tail;
+  int x, y;
+  int nx, ny;
+  int dir;
+
+  memset(first, 0xff, sizeof(first));
+
+  head = 0;
+  tail = 0;
+
+  for (dir = 1; dir <= 8; dir++) {
+    nx = playerx + diroffx[dir];
+    ny = playery + diroffy[dir];
+    if (bot_passable(nx, ny) && (first[nx][ny] == 0xff)) {
+      if (item[nx][ny] == Goal)
+        return dir;
+      first[nx][ny] = (unsigned char)dir;
+      queue[tail++] = (short)(nx * MAXY + ny);
+    }
+  }
+  first[(int)playerx][(int)playery] = 0;
+
+  while (head < tail) {
+    x = queue[head] / MAXY;
+    y = queue[head] % MAXY;
+    head++;
+
+    for (dir = 1; dir <= 8; dir++) {
+      nx = x + diroffx[dir];
+      ny = y + diroffy[dir];
+      if (bot_passable(nx, ny) && (first[nx][ny] == 0xff)) {
+        if (item[nx][ny] == Goal)
+          return first[x][y];
+        first[nx][ny] = first[x][y];
+        queue[tail++] = (short)(nx * MAXY + ny);
+      }
+    }
+  }
+
+  return 0;
+}
+
+/* =============================================================================
+ * FUNCTION: bot_action
+ *
+ * DESCRIPTION:
+ * Choose the bot's next command.
+ *
+ * PARAMETERS:
+ *
+ *   None.
+ *
+ * RETURN VALUE:
+ *
+ *   The command action.
+ */
+static ActionType bot_action(void) {
+  int dir;
+  int x, y;
+
+  //
+  // Wait if no command has taken a move this turn, such as when walled in
+  //
+  if (BotTurn != gtime) {
+    BotTurn = gtime;
+    BotTries = 0;
+  }
+  if (++BotTries > BOT_MAX_TRIES)
+    return ACTION_WAIT;
+
+  //
+  // Attack any adjacent monster
+  //
+  for (dir = 1; dir <= 8; dir++) {
+    x = playerx + diroffx[dir];
+    y = playery + diroffy[dir];
+    if ((x >= 0) && (x < MAXX) && (y >= 0) && (y < MAXY) &&
+        (mitem[x][y].mon != MONST_NONE))
+      return DirAction[dir];
+  }
+
+  //
+  // Rest when badly hurt
+  //
+  if (c[HP] < c[HPMAX] / 3)
+    return ACTION_WAIT;
+
+  //
+  // Head down
+  //
+  dir = bot_path((level == 0) ? OENTRANCE : OSTAIRSDOWN);
+  if (dir == 0)
+    dir = rnd(8);
+
+  return DirAction[dir];
+}
+
+/* =============================================================================
+ * FUNCTION: bot_answer
+ *
+ * DESCRIPTION:
+ * Choose the bot's answer to a prompt.
+ * The bot goes into the dungeon, down stairs and through doors, takes items
+ * and otherwise gives the least committal answer available.
+ *
+ * PARAMETERS:
+ *
+ *   prompt  : The prompt text
+ *
+ *   answers : The valid answers
+ *
+ * RETURN VALUE:
+ *
+ *   The answer.
+ */
+static char bot_answer(char *prompt, char *answers) {
+  char *wanted;
+
+  (void)prompt;
+
+  switch (item[(int)playerx][(int)playery]) {
+  case OENTRANCE:
+    wanted = "g";
+    break;
+  case OSTAIRSDOWN:
+    wanted = "d";
+    break;
+  case OCLOSEDDOOR:
+    wanted = "o";
+    break;
+  default:
+    wanted = "t";
+    break;
+  }
+
+  if (strchr(answers, wanted[0]) != NULL)
+    return wanted[0];
+  if (strchr(answers, ESC) != NULL)
+    return ESC;
+  if (strchr(answers, '\015') != NULL)
+    return '\015';
+
+  return answers[0];
+}
+
+/* =============================================================================
+ * FUNCTION: add_state_digest
+ *
+ * DESCRIPTION:
+ * Add the digest of the current game state to the result for the game.
+ *
+ * PARAMETERS:
+ *
+ *   None.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+static void add_state_digest(void) {
+  DigestType Digest;
+
+  Digest = digest_state();
+  CurrentResult->Digest =
+      digest_bytes(CurrentResult->Digest, &Digest, sizeof(Digest));
+}
+
+/* =============================================================================
+ * FUNCTION: game_over
+ *
+ * DESCRIPTION:
+ * Record the result of the game on this thread, free the game's memory and
+ * end the thread.
+ *
+ * PARAMETERS:
+ *
+ *   Reason  : How the game ended
+ *
+ *   Monster : The monster involved in the player's death (if any)
+ *
+ * RETURN VALUE:
+ *
+ *   This function does not return.
+ */
+static void game_over(DiedReasonType Reason, int Monster) {
+  int dlev;
+
+  (void)Monster;
+
+  CurrentResult->Reason = Reason;
+  CurrentResult->Turns = gtime;
+  CurrentResult->Score = calc_score(Reason == DIED_WINNER);
+  CurrentResult->LevelBytes = level_storage_size();
+  add_state_digest();
+
+  CurrentResult->Deepest = 0;
+  for (dlev = 0; dlev < NLEVELS; dlev++)
+    if (beenhere[dlev])
+      CurrentResult->Deepest = dlev;
+
+  free_cells();
+  free_spheres();
+  free_fortunes();
+
+  pthread_exit(NULL);
+}
+
+/* =============================================================================
+ * FUNCTION: play_game
+ *
+ * DESCRIPTION:
+ * Thread function to play one game with the bot.
+ *
+ * PARAMETERS:
+ *
+ *   arg : The SimResult for the game, with the seed set.
+ *
+ * RETURN VALUE:
+ *
+ *   This function does not return.
+ */
+static void *play_game(void *arg) {
+  CurrentResult = (struct SimResult *)arg;
+
+  set_game_over(game_over);
+  set_headless_input(bot_action, bot_answer);
+
+  strcpy(loginname, "bot");
+  strcpy(logname, "bot");
+
+  //
+  // Set up the game as ULarnSetup does for a new game
+  //
+  init_cells();
+  newgame();
+  rng_seed(CurrentResult->Seed);
+  makeplayer();
+  newcavelevel(0);
+  sethard(Hardness);
+  set_display(DISPLAY_MAP);
+
+  CurrentResult->Digest = DIGEST_INIT;
+
+  while (gtime < TurnLimit) {
+    game_turn();
+    if (TurnDigests)
+      add_state_digest();
+  }
+
+  game_over(SIM_TURN_LIMIT, 0);
+
+  return NULL;
+}
+
+/* =============================================================================
+ * FUNCTION: worker
+ *
+ * DESCRIPTION:
+ * Worker thread function.
+ * Plays games until all games have been played.
+ *
+ * PARAMETERS:
+ *
+ *   arg : Not used.
+ *
+ * RETURN VALUE:
+ *
+ *   NULL.
+ */
+static void *worker(void *arg) {
+  pthread_t game;
+  int idx;
+
+  (void)arg;
+
+  for (;;) {
+    pthread_mutex_lock(&NextGameLock);
+    idx = NextGame++;
+    pthread_mutex_unlock(&NextGameLock);
+
+    if (idx >= Games)
+      break;
+
+    //
+    // Each game gets a new thread so that it starts from the initial state
+    //
+    if (pthread_create(&game, NULL, play_game, &Results[idx]) != 0) {
+      fprintf(stderr, "Cannot create a thread for game %d\n", idx);
+      continue;
+    }
+    pthread_join(game, NULL);
+  }
+
+  return NULL;
+}
+
+/* =============================================================================
+ * FUNCTION: compare_long
+ *
+ * DESCRIPTION:
+ * qsort comparison function for longs.
+ *
+ * PARAMETERS:
+ *
+ *   a : The first value
+ *
+ *   b : The second value
+ *
+ * RETURN VALUE:
+ *
+ *   <0, 0 or >0 as a is less than, equal to or greater than b.
+ */
+static int compare_long(const void *a, const void *b) {
+  long la = *(const long *)a;
+  long lb = *(const long *)b;
+
+  return (la > lb) - (la < lb);
+}
+
+/* =============================================================================
+ * FUNCTION: show_distribution
+ *
+ * DESCRIPTION:
+ * Print the distribution of a set of values. The values are sorted.
+ *
+ * PARAMETERS:
+ *
+ *   Name   : The name of the values
+ *
+ *   Values : The values
+ *
+ *   Count  : The number of values
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+static void show_distribution(char *Name, long *Values, int Count) {
+  double total;
+  int i;
+
+  qsort(Values, Count, sizeof(long), compare_long);
+
+  total = 0.0;
+  for (i = 0; i < Count; i++)
+    total += (double)Values[i];
+
+  printf("%-6s min %ld, p10 %ld, median %ld, mean %.1f, p90 %ld, max %ld\n",
+         Name, Values[0], Values[Count / 10], Values[Count / 2],
+         total / (double)Count, Values[(Count * 9) / 10], Values[Count - 1]);
+}
+
+/* =============================================================================
+ * FUNCTION: show_results
+ *
+ * DESCRIPTION:
+ * Print the simulation rate and the distributions of the game results.
+ *
+ * PARAMETERS:
+ *
+ *   Elapsed : The elapsed time of the simulation in seconds.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+static void show_results(double Elapsed) {
+  int Reasons[DIED_COUNT + 1];
+  int Levels[NLEVELS];
+  long *Values;
+  long TotalTurns;
+  DigestType Digest;
+  char *Name;
+  int i;
+
+  memset(Reasons, 0, sizeof(Reasons));
+  memset(Levels, 0, sizeof(Levels));
+  TotalTurns = 0;
+  Digest = DIGEST_INIT;
+
+  for (i = 0; i < Games; i++) {
+    Reasons[Results[i].Reason]++;
+    Levels[Results[i].Deepest]++;
+    TotalTurns += Results[i].Turns;
+    Digest = digest_bytes(Digest, &Results[i].Digest, sizeof(Results[i].Digest));
+  }
+
+  printf("%d games, %d threads, seeds %lu to %lu, turn limit %ld\n", Games,
+         Threads, BaseSeed, BaseSeed + (unsigned long)Games - 1, TurnLimit);
+  printf("%.3f s, %.1f games/sec, %.0f turns/sec\n", Elapsed,
+         (double)Games / Elapsed, (double)TotalTurns / Elapsed);
+  printf("State digest %016llx (%s)\n", Digest,
+         TurnDigests ? "every turn" : "end of game");
+
+  printf("\nEnd of game:\n");
+  for (i = 0; i <= DIED_COUNT; i++) {
+    if (Reasons[i] == 0)
+      continue;
+
+    if (i == SIM_TURN_LIMIT)
+      Name = "reached the turn limit";
+    else if (i == DIED_QUICK_QUIT)
+      Name = "quit";
+    else
+      Name = died_reason((DiedReasonType)i);
+
+    printf("  %7d %5.1f%%  %s\n", Reasons[i],
+           100.0 * (double)Reasons[i] / (double)Games, Name);
+  }
+
+  printf("\nDeepest level:\n");
+  for (i = 0; i < NLEVELS; i++) {
+    if (Levels[i] == 0)
+      continue;
+
+    printf("  %7d %5.1f%%  %s\n", Levels[i],
+           100.0 * (double)Levels[i] / (double)Games, levelname[i]);
+  }
+
+  printf("\n");
+
+  Values = (long *)malloc(Games * sizeof(long));
+  if (Values == NULL)
+    return;
+
+  for (i = 0; i < Games; i++)
+    Values[i] = Results[i].Turns;
+  show_distribution("Turns:", Values, Games);
+
+  for (i = 0; i < Games; i++)
+    Values[i] = Results[i].Score;
+  show_distribution("Score:", Values, Games);
+
+  for (i = 0; i < Games; i++)
+    Values[i] = Results[i].LevelBytes;
+  show_distribution("Level bytes:", Values, Games);
+
+  free(Values);
+}
+
+/* =============================================================================
+ * Exported functions
+ */
+
+/* =============================================================================
+ * FUNCTION: main
+ */
+int main(int argc, char *argv[]) {
+  pthread_t *pool;
+  double start;
+  int i;
+
+  opterr = 0;
+  while ((i = ugetopt(argc, argv, optstring)) != -1) {
+    switch (i) {
+    case 'D':
+      TurnDigests = 1;
+      break;
+
+    case 'g':
+      Games = atoi(optarg);
+      break;
+
+    case 'j':
+      Threads = atoi(optarg);
+      break;
+
+    case 'S':
+      BaseSeed = strtoul(optarg, NULL, 0);
+      break;
+
+    case 't':
+      TurnLimit = atol(optarg);
+      break;
+
+    case 'd':
+      Hardness = atoi(optarg);
+      if (Hardness > 100)
+        Hardness = 100;
+      break;
+
+    case 'r':
+      roam_budget = atoi(optarg);
+      break;
+
+    case 'c':
+      catchup = 1;
+      break;
+
+    case 'p':
+      pack_levels = 1;
+      break;
+
+    default:
+      fprintf(stderr, "%s", cmdhelp);
+      return (i == 'h') ? 0 : 1;
+    }
+  }
+
+  if (Games <= 0) {
+    fprintf(stderr, "The number of games must be > 0\n");
+    return 1;
+  }
+
+  if (Threads <= 0)
+    Threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if (Threads <= 0)
+    Threads = 1;
+  if (Threads > Games)
+    Threads = Games;
+
+  //
+  // Game options shared by all games
+  //
+  nonap = 1;
+  ckpflag = 0;
+  nowelcome = 1;
+  sprintf(helpfile, "%s/%s", libdir, HELPNAME);
+  sprintf(larnlevels, "%s/%s", libdir, LEVELSNAME);
+  sprintf(fortfile, "%s/%s", libdir, FORTSNAME);
+
+  Results = (struct SimResult *)calloc(Games, sizeof(struct SimResult));
+  pool = (pthread_t *)malloc(Threads * sizeof(pthread_t));
+  if ((Results == NULL) || (pool == NULL)) {
+    fprintf(stderr, "Out of memory\n");
+    return 1;
+  }
+
+  for (i = 0; i < Games; i++)
+    Results[i].Seed = BaseSeed + (unsigned long)i;
+
+  start = sim_clock();
+
+  for (i = 0; i < Threads; i++) {
+    if (pthread_create(&pool[i], NULL, worker, NULL) != 0) {
+      fprintf(stderr, "Cannot create worker thread %d\n", i);
+      Threads = i;
+      break;
+    }
+  }
+
+  if (Threads == 0)
+    worker(NULL);
+
+  for (i = 0; i < Threads; i++)
+    pthread_join(pool[i], NULL);
+
+  show_results(sim_clock() - start);
+
+  free(pool);
+  free(Results);
+
+  return 0;
+}
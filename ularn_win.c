@@ -68,6 +68,7 @@
 #include "monster.h"
 #include "player.h"
 #include "ularn_win.h"
+#include "vclock.h"
 #include "ularnpc.rh"
 
 //
@@ -91,7 +92,7 @@ int nosignal = 0;
 
 char enable_scroll = 0;
 
-int yrepcount = 0;
+GAME_LOCAL int yrepcount = 0;
 
 /* =============================================================================
  * Local variables
@@ -179,7 +180,8 @@ static struct KeyCodeType KeyMap[ACTION_COUNT][MAX_KEY_BINDINGS] = {
     {{'v', M_ASCII}, {0, 0}, {0, 0}},            // ACTION_VERSION,
     {{'Q', M_ASCII}, {0, 0}, {0, 0}},            // ACTION_QUIT,
     {{'R', M_CTRL}, {0, 0}, {0, 0}},             // ACTION_REDRAW_SCREEN,
-    {{'P', M_ASCII}, {0, 0}, {0, 0}}             // ACTION_SHOW_TAX
+    {{'P', M_ASCII}, {0, 0}, {0, 0}},            // ACTION_SHOW_TAX
+    {{'|', M_ASCII}, {0, 0}, {0, 0}}             // ACTION_PROFILE
 };
 
 static struct KeyCodeType RunKeyMap = {VK_NUMPAD5, M_NONE};
@@ -3035,7 +3037,7 @@ void nap(int delay) {
   MSG msg; // generic message
   int time_left;
 
-  time_left = delay;
+  time_left = vclock_nap(delay);
   while (time_left > 0) {
     if (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
       //
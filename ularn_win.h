@@ -93,7 +93,7 @@ extern int nosignal;
 extern char enable_scroll;
 
 /* Repeat count for the current command */
-extern int yrepcount;
+extern GAME_LOCAL int yrepcount;
 
 /*
  * Display modes for the main window
@@ -188,6 +188,7 @@ typedef enum ActionType {
   ACTION_QUIT,
   ACTION_REDRAW_SCREEN,
   ACTION_SHOW_TAX,
+  ACTION_PROFILE,
   ACTION_COUNT
 } ActionType;
 
@@ -79,6 +79,7 @@
 #include "monster.h"
 #include "player.h"
 #include "ularn_win.h"
+#include "vclock.h"
 #include "ularnpc.rh"
 
 #include "ifftools.h"
@@ -110,7 +111,7 @@ int nosignal = 0;
 
 char enable_scroll = 0;
 
-int yrepcount = 0;
+GAME_LOCAL int yrepcount = 0;
 
 /* =============================================================================
  * Local variables
@@ -201,7 +202,8 @@ static struct KeyCodeType KeyMap[ACTION_COUNT][MAX_KEY_BINDINGS] = {
     {{'v', M_ASCII}, {0, 0}, {0, 0}},  // ACTION_VERSION,
     {{'Q', M_ASCII}, {0, 0}, {0, 0}},  // ACTION_QUIT,
     {{0x12, M_ASCII}, {0, 0}, {0, 0}}, // ACTION_REDRAW_SCREEN,
-    {{'P', M_ASCII}, {0, 0}, {0, 0}}   // ACTION_SHOW_TAX
+    {{'P', M_ASCII}, {0, 0}, {0, 0}},  // ACTION_SHOW_TAX
+    {{'|', M_ASCII}, {0, 0}, {0, 0}}   // ACTION_PROFILE
 };
 
 static struct KeyCodeType RunKeyMap = {'5', M_NUMPAD};
@@ -2526,7 +2528,9 @@ void nap(int delay) {
   //
   // Delay for delay/20 ticks (50 ticks per second)
   //
-  Delay(delay / 20);
+  delay = vclock_nap(delay);
+  if (delay > 0)
+    Delay(delay / 20);
 }
 
 //
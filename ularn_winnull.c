@@ -0,0 +1,497 @@
+/* =============================================================================
+ * PROGRAM:  ularn
+ * FILENAME: ularn_winnull.c
+ *
+ * DESCRIPTION:
+ * This module contains all operating system dependant code for input and
+ * display update.
+ * Each version of ularn should provide a different implementation of this
+ * module.
+ *
+ * This is the headless (null) display module.
+ * Nothing is drawn and no terminal is required, so the game core can be run
+ * from scripts, simulators and benchmarks.
+ * Display calls only maintain the game state side effects that the other
+ * display modules have (the player's map knowledge and monster sightings).
+ * Input is read from the action script, if there is one, then from the
+ * input functions set by the program running the game (such as a bot), and
+ * when no input is available the player is treated as having quit.
+ *
+ * =============================================================================
+ * EXPORTED VARIABLES
+ *
+ * nonap         : Set to true if no time delays are to be used.
+ * nosignal      : Set if ctrl-C is to be trapped to prevent exit.
+ * enable_scroll : Probably superfluous
+ * yrepcount     : Repeat count for input commands.
+ *
+ * =============================================================================
+ * EXPORTED FUNCTIONS
+ *
+ * init_app               : Initialise the app
+ * close_app              : Close the app and free resources
+ * get_normal_input       : Get the next command input
+ * get_prompt_input       : Get input in response to a question
+ * get_password_input     : Get a password
+ * get_num_input          : Geta number
+ * get_dir_input          : Get a direction
+ * set_display            : Set the display mode
+ * UpdateStatus           : Update the status display
+ * UpdateEffects          : Update the effects display
+ * UpdateStatusAndEffects : Update both status and effects display
+ * ClearText              : Clear the text output area
+ * UlarnBeep              : Make a beep
+ * MoveCursor             : Set the cursor location
+ * Printc                 : Print a single character
+ * Print                  : Print a string
+ * Printf                 : Print a formatted string
+ * Standout               : Print a string is standout format
+ * SetFormat              : Set the output text format
+ * ClearEOL               : Clear to end of line
+ * ClearEOPage            : Clear to end of page
+ * show1cell              : Show 1 cell on the map
+ * showplayer             : Show the player on the map
+ * showcell               : Show the area around the player
+ * drawscreen             : Redraw the screen
+ * draws                  : Redraw a section of the screen
+ * mapeffect              : Draw a directional effect
+ * magic_effect_frames    : Get the number of animation frames in a magic fx
+ * magic_effect           : Draw a frame in a magic fx
+ * nap                    : Delay for a specified number of milliseconds
+ * GetUser                : Get the username and user id.
+ * set_headless_input     : Set the functions supplying input
+ *
+ * =============================================================================
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "config.h"
+
+#include "header.h"
+#include "ularn_game.h"
+
+#include "dungeon.h"
+#include "itm.h"
+#include "monster.h"
+#include "player.h"
+#include "scores.h"
+#include "ularn_script.h"
+#include "vclock.h"
+#include "ularn_win.h"
+#include "ularn_winnull.h"
+
+/* =============================================================================
+ * Exported variables
+ */
+
+int nonap = 0;
+int nosignal = 0;
+
+char enable_scroll = 0;
+
+GAME_LOCAL int yrepcount = 0;
+
+/* =============================================================================
+ * Local variables
+ */
+
+/*
+ * The default user name if none is available from the environment
+ */
+#define HEADLESS_USER "headless"
+
+/*
+ * Number of frames in each magic effect.
+ * This must match the other display modules so that spell timing is the
+ * same with and without a display.
+ */
+static int magicfx_frames[MAGIC_COUNT] = {8, 6, 6, 6, 6, 6, 6, 6,
+                                          6, 6, 6, 6, 6, 6, 6};
+
+static GAME_LOCAL DisplayModeType CurrentDisplayMode = DISPLAY_TEXT;
+static GAME_LOCAL FormatType CurrentFormat = FORMAT_NORMAL;
+
+/*
+ * The input functions set by the program running the game
+ */
+static GAME_LOCAL HeadlessActionFunc InputAction = NULL;
+static GAME_LOCAL HeadlessAnswerFunc InputAnswer = NULL;
+
+/* =============================================================================
+ * Local functions
+ */
+
+/* =============================================================================
+ * FUNCTION: no_input
+ *
+ * DESCRIPTION:
+ * Called when the game requires a command and there is no input source.
+ * This is treated as the player quitting, and does not return.
+ *
+ * PARAMETERS:
+ *
+ *   None.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+static void no_input(void) { died(DIED_QUICK_QUIT, 0); }
+
+/* =============================================================================
+ * Exported functions
+ */
+
+/* =============================================================================
+ * FUNCTION: init_app
+ */
+int init_app(void) {
+  vclock_set_mode(VCLOCK_VIRTUAL, 0.0);
+
+  CurrentDisplayMode = DISPLAY_TEXT;
+  CurrentFormat = FORMAT_NORMAL;
+
+  return 1;
+}
+
+/* =============================================================================
+ * FUNCTION: close_app
+ */
+void close_app(void) {}
+
+/* =============================================================================
+ * FUNCTION: get_normal_input
+ */
+ActionType get_normal_input(void) {
+  ActionType Action;
+
+  if (!script_action(&Action)) {
+    if (InputAction != NULL)
+      Action = InputAction();
+    else {
+      no_input();
+      Action = ACTION_NULL;
+    }
+  }
+
+  script_record_action(Action);
+
+  return Action;
+}
+
+/* =============================================================================
+ * FUNCTION: get_prompt_input
+ */
+char get_prompt_input(char *prompt, char *answers, int ShowCursor) {
+  char Answer;
+
+  (void)ShowCursor;
+
+  Print(prompt);
+
+  if (!script_answer(answers, &Answer)) {
+    //
+    // Without an input function, take the least committal answer available:
+    // escape, then return, and failing both the first answer offered.
+    //
+    if (InputAnswer != NULL)
+      Answer = InputAnswer(prompt, answers);
+    else if (strchr(answers, ESC) != NULL)
+      Answer = ESC;
+    else if (strchr(answers, '\015') != NULL)
+      Answer = '\015';
+    else
+      Answer = answers[0];
+  }
+
+  script_record_answer(Answer);
+
+  return Answer;
+}
+
+/* =============================================================================
+ * FUNCTION: get_password_input
+ */
+void get_password_input(char *password, int Len) {
+  if (!script_password(password, Len))
+    password[0] = 0;
+
+  script_record_password(password);
+}
+
+/* =============================================================================
+ * FUNCTION: get_num_input
+ */
+int get_num_input(int defval) {
+  int value;
+
+  if (!script_number(defval, &value))
+    value = defval;
+
+  script_record_number(value);
+
+  return value;
+}
+
+/* =============================================================================
+ * FUNCTION: get_dir_input
+ */
+ActionType get_dir_input(char *prompt, int ShowCursor) {
+  ActionType Action;
+
+  (void)ShowCursor;
+
+  Print(prompt);
+
+  //
+  // Ignore non-direction actions, as the other display modules do
+  //
+  do {
+    Action = get_normal_input();
+  } while ((Action < ACTION_MOVE_WEST) || (Action > ACTION_RUN_SOUTHWEST) ||
+           (((Action - ACTION_MOVE_WEST) & 1) != 0));
+
+  return Action;
+}
+
+/* =============================================================================
+ * FUNCTION: UpdateStatus
+ */
+void UpdateStatus(void) {}
+
+/* =============================================================================
+ * FUNCTION: UpdateEffects
+ */
+void UpdateEffects(void) {}
+
+/* =============================================================================
+ * FUNCTION: UpdateStatusAndEffects
+ */
+void UpdateStatusAndEffects(void) {}
+
+/* =============================================================================
+ * FUNCTION: set_display
+ */
+void set_display(DisplayModeType Mode) { CurrentDisplayMode = Mode; }
+
+/* =============================================================================
+ * FUNCTION: ClearText
+ */
+void ClearText(void) {}
+
+/* =============================================================================
+ * FUNCTION: UlarnBeep
+ */
+void UlarnBeep(void) {}
+
+/* =============================================================================
+ * FUNCTION: MoveCursor
+ */
+void MoveCursor(int x, int y) {
+  (void)x;
+  (void)y;
+}
+
+/* =============================================================================
+ * FUNCTION: Printc
+ */
+void Printc(char c) { (void)c; }
+
+/* =============================================================================
+ * FUNCTION: Print
+ */
+void Print(char *string) { (void)string; }
+
+/* =============================================================================
+ * FUNCTION: Printf
+ */
+void Printf(char *fmt, ...) {
+  char buf[2048];
+  va_list argptr;
+
+  va_start(argptr, fmt);
+  vsnprintf(buf, sizeof(buf), fmt, argptr);
+  va_end(argptr);
+
+  Print(buf);
+}
+
+/* =============================================================================
+ * FUNCTION: Standout
+ */
+void Standout(char *String) {
+  FormatType OldFormat = CurrentFormat;
+
+  CurrentFormat = FORMAT_STANDOUT;
+  Print(String);
+  CurrentFormat = OldFormat;
+}
+
+/* =============================================================================
+ * FUNCTION: SetFormat
+ */
+void SetFormat(FormatType format) { CurrentFormat = format; }
+
+/* =============================================================================
+ * FUNCTION: ClearToEOL
+ */
+void ClearToEOL(void) {}
+
+/* =============================================================================
+ * FUNCTION: ClearToEOPage
+ */
+void ClearToEOPage(int x, int y) {
+  (void)x;
+  (void)y;
+}
+
+/* =============================================================================
+ * FUNCTION: show1cell
+ */
+void show1cell(int x, int y) {
+  /* see nothing if blind */
+  if (c[BLINDCOUNT])
+    return;
+
+  /* we end up knowing about it */
+  know[x][y] = item[x][y];
+  if (mitem[x][y].mon != MONST_NONE)
+    stealth[x][y] |= STEALTH_SEEN;
+}
+
+/* =============================================================================
+ * FUNCTION: showplayer
+ */
+void showplayer(void) {}
+
+/* =============================================================================
+ * FUNCTION: showcell
+ */
+void showcell(int x, int y) {
+  int minx, maxx;
+  int miny, maxy;
+  int mx, my;
+
+  /*
+   * Decide how much the player knows about around him/her.
+   */
+  if (c[AWARENESS]) {
+    minx = x - 3;
+    maxx = x + 3;
+    miny = y - 3;
+    maxy = y + 3;
+  } else {
+    minx = x - 1;
+    maxx = x + 1;
+    miny = y - 1;
+    maxy = y + 1;
+  }
+
+  if (c[BLINDCOUNT]) {
+    minx = x;
+    maxx = x;
+    miny = y;
+    maxy = y;
+  }
+
+  /*
+   * Limit the area to the map extents
+   */
+  if (minx < 0)
+    minx = 0;
+  if (maxx > MAXX - 1)
+    maxx = MAXX - 1;
+  if (miny < 0)
+    miny = 0;
+  if (maxy > MAXY - 1)
+    maxy = MAXY - 1;
+
+  for (my = miny; my <= maxy; my++) {
+    for (mx = minx; mx <= maxx; mx++) {
+      know[mx][my] = item[mx][my];
+      if ((mitem[mx][my].mon != MONST_NONE) &&
+          ((mx != playerx) || (my != playery)))
+        stealth[mx][my] |= STEALTH_SEEN;
+    }
+  }
+
+  showplayer();
+}
+
+/* =============================================================================
+ * FUNCTION: drawscreen
+ */
+void drawscreen(void) {}
+
+/* =============================================================================
+ * FUNCTION: draws
+ */
+void draws(int minx, int miny, int maxx, int maxy) {
+  (void)minx;
+  (void)miny;
+  (void)maxx;
+  (void)maxy;
+}
+
+/* =============================================================================
+ * FUNCTION: mapeffect
+ */
+void mapeffect(int x, int y, DirEffectsType effect, int dir) {
+  (void)x;
+  (void)y;
+  (void)effect;
+  (void)dir;
+}
+
+/* =============================================================================
+ * FUNCTION: magic_effect_frames
+ */
+int magic_effect_frames(MagicEffectsType fx) { return magicfx_frames[fx]; }
+
+/* =============================================================================
+ * FUNCTION: magic_effect
+ */
+void magic_effect(int x, int y, MagicEffectsType fx, int frame) {
+  (void)x;
+  (void)y;
+  (void)fx;
+  (void)frame;
+}
+
+/* =============================================================================
+ * FUNCTION: nap
+ */
+void nap(int delay) {
+  /* Nothing is displayed, so there is nothing to wait for */
+  (void)vclock_nap(delay);
+}
+
+/* =============================================================================
+ * FUNCTION: GetUser
+ */
+void GetUser(char *username, int *uid) {
+  char *name;
+
+  *uid = getuid();
+
+  name = getenv("USER");
+  if ((name == NULL) || (name[0] == 0))
+    name = HEADLESS_USER;
+
+  strncpy(username, name, USERNAME_LENGTH);
+  username[USERNAME_LENGTH] = 0;
+}
+
+/* =============================================================================
+ * FUNCTION: set_headless_input
+ */
+void set_headless_input(HeadlessActionFunc GetAction,
+                        HeadlessAnswerFunc GetAnswer) {
+  InputAction = GetAction;
+  InputAnswer = GetAnswer;
+}
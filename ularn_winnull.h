@@ -0,0 +1,62 @@
+/* =============================================================================
+ * PROGRAM:  ularn
+ * FILENAME: ularn_winnull.h
+ *
+ * DESCRIPTION:
+ * Functions specific to the headless (null) display module.
+ * The common display interface is in ularn_win.h.
+ *
+ * =============================================================================
+ * EXPORTED VARIABLES
+ *
+ * None.
+ *
+ * =============================================================================
+ * EXPORTED FUNCTIONS
+ *
+ * set_headless_input : Set the functions supplying input
+ *
+ * =============================================================================
+ */
+
+#ifndef __ULARN_WINNULL_H
+# define __ULARN_WINNULL_H
+
+# include "ularn_win.h"
+
+/*
+ * A function to supply the next command action
+ */
+typedef ActionType (*HeadlessActionFunc)(void);
+
+/*
+ * A function to answer a prompt.
+ * This must return one of the characters in answers.
+ */
+typedef char (*HeadlessAnswerFunc)(char *prompt, char *answers);
+
+/* =============================================================================
+ * FUNCTION: set_headless_input
+ *
+ * DESCRIPTION:
+ * Set the functions supplying input when there is no action script.
+ * Directions are taken from the command actions, numbers use the default
+ * value and passwords are empty.
+ * The setting applies to the current thread's game only.
+ *
+ * PARAMETERS:
+ *
+ *   GetAction : The function supplying command actions, or NULL to treat
+ *               the player as having quit when a command is required.
+ *
+ *   GetAnswer : The function answering prompts, or NULL to take the least
+ *               committal answer available.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+void set_headless_input(HeadlessActionFunc GetAction,
+                        HeadlessAnswerFunc GetAnswer);
+
+#endif
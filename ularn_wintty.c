@@ -70,6 +70,8 @@
 #include "itm.h"
 #include "monster.h"
 #include "player.h"
+#include "ularn_script.h"
+#include "vclock.h"
 #include "ularn_win.h"
 
 //
@@ -89,7 +91,7 @@ int nosignal = 0;
 
 char enable_scroll = 0;
 
-int yrepcount = 0;
+GAME_LOCAL int yrepcount = 0;
 
 /* =============================================================================
  * Local variables
@@ -164,7 +166,8 @@ static struct KeyCodeType KeyMap[ACTION_COUNT][MAX_KEY_BINDINGS] = {
     {{'v', M_ASCII}, {0, 0}, {0, 0}},               // ACTION_VERSION,
     {{'Q', M_ASCII}, {0, 0}, {0, 0}},               // ACTION_QUIT,
     {{18, M_ASCII}, {0, 0}, {0, 0}},                // ACTION_REDRAW_SCREEN,
-    {{'P', M_ASCII}, {0, 0}, {0, 0}}                // ACTION_SHOW_TAX
+    {{'P', M_ASCII}, {0, 0}, {0, 0}},               // ACTION_SHOW_TAX
+    {{'|', M_ASCII}, {0, 0}, {0, 0}}                // ACTION_PROFILE
 };
 
 static struct KeyCodeType RunKeyMap = {KEY_B2, M_ASCII};
@@ -945,6 +948,132 @@ static void PaintWindow(void) {
   Repaint = 0;
 }
 
+/* =============================================================================
+ * FUNCTION: read_answer
+ *
+ * DESCRIPTION:
+ * Read keys until one of the answers is pressed.
+ *
+ * PARAMETERS:
+ *
+ *   answers    : The set of valid answers.
+ *
+ *   ShowCursor : Set to display the cursor while waiting.
+ *
+ * RETURN VALUE:
+ *
+ *   The answer pressed.
+ */
+static char read_answer(char *answers, int ShowCursor) {
+  char *ch;
+
+  if (ShowCursor)
+    CaretActive = 1;
+
+  //
+  // Process events until a character in answers has been pressed.
+  //
+  GotChar = 0;
+  while (!GotChar) {
+    wrefresh(TextWindow);
+
+    EventChar = getch();
+    GotChar = 1;
+
+    if (GotChar) {
+
+      //
+      // Search for the input character in the answers string
+      //
+      ch = strchr(answers, EventChar);
+
+      if (ch == NULL) {
+        //
+        // Not an answer we want
+        //
+        GotChar = 0;
+      }
+    }
+  }
+
+  if (ShowCursor)
+    CaretActive = 0;
+
+  return EventChar;
+}
+
+/* =============================================================================
+ * FUNCTION: read_number
+ *
+ * DESCRIPTION:
+ * Read a number from the keyboard.
+ *
+ * PARAMETERS:
+ *
+ *   defval : The value to return if no digits are entered, or '*' is pressed.
+ *
+ * RETURN VALUE:
+ *
+ *   The number entered.
+ */
+static int read_number(int defval) {
+  char ch;
+  int Pos = 0;
+  int value = 0;
+  int neg = 0;
+
+  do {
+    ch = read_answer("-*0123456789\010\015", 1);
+
+    if ((ch == '-') && (Pos == 0)) {
+      //
+      // Minus
+      //
+      neg = 1;
+      Printc(ch);
+      Pos++;
+    }
+    if (ch == '*')
+      return defval;
+    else if (ch == '\010') {
+      //
+      // Backspace
+      //
+
+      if (Pos > 0) {
+        if ((Pos == 1) && neg)
+          neg = 0;
+        else
+          value = value / 10;
+
+        CursorX--;
+        Printc(' ');
+        CursorX--;
+        Pos--;
+        wmove(TextWindow, CursorY - 1, CursorX - 1);
+        wrefresh(TextWindow);
+      }
+    } else if ((ch >= '0') && (ch <= '9')) {
+      //
+      // digit
+      //
+      value = value * 10 + (ch - '0');
+      Printc(ch);
+      Pos++;
+    }
+
+  } while (ch != '\015');
+
+  if (Pos == 0)
+    return defval;
+  else {
+    if (neg)
+      value = -value;
+
+    return value;
+  }
+}
+
 /* =============================================================================
  * Exported functions
  */
@@ -1048,6 +1177,12 @@ ActionType get_normal_input(void) {
   Event = ACTION_NULL;
   Runkey = 0;
 
+  if (script_action(&Action)) {
+    Event = Action;
+    script_record_action(Event);
+    return Event;
+  }
+
   while (Event == ACTION_NULL) {
     wrefresh(MapWindow);
     EventChar = getch();
@@ -1115,6 +1250,8 @@ ActionType get_normal_input(void) {
       Event = Event + 1;
   }
 
+  script_record_action(Event);
+
   return Event;
 }
 
@@ -1122,43 +1259,16 @@ ActionType get_normal_input(void) {
  * FUNCTION: get_prompt_input
  */
 char get_prompt_input(char *prompt, char *answers, int ShowCursor) {
-  char *ch;
+  char Answer;
 
   Print(prompt);
 
-  if (ShowCursor)
-    CaretActive = 1;
-
-  //
-  // Process events until a character in answers has been pressed.
-  //
-  GotChar = 0;
-  while (!GotChar) {
-    wrefresh(TextWindow);
-
-    EventChar = getch();
-    GotChar = 1;
-
-    if (GotChar) {
-
-      //
-      // Search for the input character in the answers string
-      //
-      ch = strchr(answers, EventChar);
-
-      if (ch == NULL) {
-        //
-        // Not an answer we want
-        //
-        GotChar = 0;
-      }
-    }
-  }
+  if (!script_answer(answers, &Answer))
+    Answer = read_answer(answers, ShowCursor);
 
-  if (ShowCursor)
-    CaretActive = 0;
+  script_record_answer(Answer);
 
-  return EventChar;
+  return Answer;
 }
 
 /* =============================================================================
@@ -1170,6 +1280,11 @@ void get_password_input(char *password, int Len) {
   int Pos;
   int value;
 
+  if (script_password(password, Len)) {
+    script_record_password(password);
+    return;
+  }
+
   /* get the printable characters on this system */
   Pos = 0;
   for (value = 0; value < 256; value++) {
@@ -1186,7 +1301,7 @@ void get_password_input(char *password, int Len) {
 
   Pos = 0;
   do {
-    ch = get_prompt_input("", inputchars, 1);
+    ch = read_answer(inputchars, 1);
 
     if (isprint((int)ch) && (Pos < Len)) {
       password[Pos] = ch;
@@ -1211,6 +1326,8 @@ void get_password_input(char *password, int Len) {
   } while (ch != '\015');
 
   password[Pos] = 0;
+
+  script_record_password(password);
 }
 #if 0
 /* =============================================================================
@@ -1271,61 +1388,14 @@ static void get_string_input(char *string, int Len)
  * FUNCTION: get_num_input
  */
 int get_num_input(int defval) {
-  char ch;
-  int Pos = 0;
-  int value = 0;
-  int neg = 0;
-
-  do {
-    ch = get_prompt_input("", "-*0123456789\010\015", 1);
-
-    if ((ch == '-') && (Pos == 0)) {
-      //
-      // Minus
-      //
-      neg = 1;
-      Printc(ch);
-      Pos++;
-    }
-    if (ch == '*')
-      return defval;
-    else if (ch == '\010') {
-      //
-      // Backspace
-      //
-
-      if (Pos > 0) {
-        if ((Pos == 1) && neg)
-          neg = 0;
-        else
-          value = value / 10;
-
-        CursorX--;
-        Printc(' ');
-        CursorX--;
-        Pos--;
-        wmove(TextWindow, CursorY - 1, CursorX - 1);
-        wrefresh(TextWindow);
-      }
-    } else if ((ch >= '0') && (ch <= '9')) {
-      //
-      // digit
-      //
-      value = value * 10 + (ch - '0');
-      Printc(ch);
-      Pos++;
-    }
+  int value;
 
-  } while (ch != '\015');
+  if (!script_number(defval, &value))
+    value = read_number(defval);
 
-  if (Pos == 0)
-    return defval;
-  else {
-    if (neg)
-      value = -value;
+  script_record_number(value);
 
-    return value;
-  }
+  return value;
 }
 
 /* =============================================================================
@@ -1859,6 +1929,10 @@ void magic_effect(int x, int y, MagicEffectsType fx, int frame) {
  * FUNCTION: nap
  */
 void nap(int delay) {
+  delay = vclock_nap(delay);
+  if (delay == 0)
+    return;
+
 #ifdef UNIX
   usleep(delay * 1000);
 #else
@@ -75,6 +75,7 @@
 #include "monster.h"
 #include "player.h"
 #include "ularn_win.h"
+#include "vclock.h"
 
 // Default size of the ularn window in characters
 #define WINDOW_WIDTH 80
@@ -92,7 +93,7 @@ int nosignal = 0;
 
 char enable_scroll = 0;
 
-int yrepcount = 0;
+GAME_LOCAL int yrepcount = 0;
 
 /* =============================================================================
  * Local variables
@@ -178,7 +179,8 @@ static struct KeyCodeType KeyMap[ACTION_COUNT][MAX_KEY_BINDINGS] = {
     {{'v', M_ASCII}, {0, 0}, {0, 0}},            // ACTION_VERSION,
     {{'Q', M_ASCII}, {0, 0}, {0, 0}},            // ACTION_QUIT,
     {{'r', M_CTRL}, {0, 0}, {0, 0}},             // ACTION_REDRAW_SCREEN,
-    {{'P', M_ASCII}, {0, 0}, {0, 0}}             // ACTION_SHOW_TAX
+    {{'P', M_ASCII}, {0, 0}, {0, 0}},            // ACTION_SHOW_TAX
+    {{'|', M_ASCII}, {0, 0}, {0, 0}}             // ACTION_PROFILE
 };
 
 static struct KeyCodeType RunKeyMap = {XK_KP_Begin, M_NONE};
@@ -1852,7 +1854,7 @@ void close_app(void) {
   if (ularn_window != None)
     XDestroyWindow(display, ularn_window);
 
-  sleep(4);
+  nap(4000);
 
   XFlush(display);
   XSync(display, 1);
@@ -2880,7 +2882,10 @@ void magic_effect(int x, int y, MagicEffectsType fx, int frame) {
 void nap(int delay) {
   XFlush(display);
   XSync(display, 0);
-  usleep(delay * 1000);
+
+  delay = vclock_nap(delay);
+  if (delay > 0)
+    usleep(delay * 1000);
 }
 
 /* =============================================================================
@@ -0,0 +1,91 @@
+/* =============================================================================
+ * PROGRAM:  ularn
+ * FILENAME: vclock.c
+ *
+ * DESCRIPTION:
+ * Virtual clock.
+ * All time delays (nap) go through this module, which decides how long the
+ * display module should actually wait and keeps count of the time asked
+ * for and the time spent waiting.
+ *
+ * =============================================================================
+ * EXPORTED VARIABLES
+ *
+ * None
+ *
+ * =============================================================================
+ * EXPORTED FUNCTIONS
+ *
+ * vclock_set_mode : Set the clock mode
+ * vclock_nap      : Account for a delay and get the time to wait
+ * vclock_report   : Write the delay totals to stderr
+ *
+ * =============================================================================
+ */
+
+#include <stdio.h>
+
+#include "config.h"
+#include "ularn_script.h"
+#include "ularn_win.h"
+#include "vclock.h"
+
+/* =============================================================================
+ * Local variables
+ */
+
+static VClockModeType ClockMode = VCLOCK_REAL;
+static double ClockScale = 1.0;
+
+/*
+ * Delay totals for the game (ms)
+ */
+static GAME_LOCAL long NapCount = 0;
+static GAME_LOCAL double RequestedTime = 0.0;
+static GAME_LOCAL double WaitedTime = 0.0;
+
+/* =============================================================================
+ * Exported functions
+ */
+
+/* =============================================================================
+ * FUNCTION: vclock_set_mode
+ */
+void vclock_set_mode(VClockModeType Mode, double Scale) {
+  ClockMode = Mode;
+  ClockScale = (Scale < 0.0) ? 0.0 : Scale;
+}
+
+/* =============================================================================
+ * FUNCTION: vclock_nap
+ */
+int vclock_nap(int delay) {
+  int wait;
+
+  if (delay <= 0)
+    return 0;
+
+  if ((ClockMode == VCLOCK_VIRTUAL) || nonap || script_active())
+    wait = 0;
+  else if (ClockMode == VCLOCK_SCALED)
+    wait = (int)((double)delay * ClockScale + 0.5);
+  else
+    wait = delay;
+
+  NapCount++;
+  RequestedTime += (double)delay;
+  WaitedTime += (double)wait;
+
+  return wait;
+}
+
+/* =============================================================================
+ * FUNCTION: vclock_report
+ */
+void vclock_report(void) {
+  if (NapCount == 0)
+    return;
+
+  fprintf(stderr, "Delays: %ld naps, %.1f s requested, %.1f s waited\n",
+          NapCount, RequestedTime / 1000.0, WaitedTime / 1000.0);
+}
@@ -0,0 +1,97 @@
+/* =============================================================================
+ * PROGRAM:  ularn
+ * FILENAME: vclock.h
+ *
+ * DESCRIPTION:
+ * Virtual clock.
+ * All time delays (nap) go through this module, which decides how long the
+ * display module should actually wait and keeps count of the time asked
+ * for and the time spent waiting.
+ *
+ * The clock has three modes:
+ *
+ *   VCLOCK_REAL    : Delays are the time asked for.
+ *   VCLOCK_SCALED  : Delays are the time asked for multiplied by a factor.
+ *   VCLOCK_VIRTUAL : There are no delays, but the time asked for is still
+ *                    counted.
+ *
+ * The clock is virtual regardless of the mode when the nonap option is set
+ * or input is being read from an action script.
+ *
+ * =============================================================================
+ * EXPORTED VARIABLES
+ *
+ * None
+ *
+ * =============================================================================
+ * EXPORTED FUNCTIONS
+ *
+ * vclock_set_mode : Set the clock mode
+ * vclock_nap      : Account for a delay and get the time to wait
+ * vclock_report   : Write the delay totals to stderr
+ *
+ * =============================================================================
+ */
+
+#ifndef __VCLOCK_H
+# define __VCLOCK_H
+
+typedef enum {
+  VCLOCK_REAL,
+  VCLOCK_SCALED,
+  VCLOCK_VIRTUAL
+} VClockModeType;
+
+/* =============================================================================
+ * FUNCTION: vclock_set_mode
+ *
+ * DESCRIPTION:
+ * Set the clock mode.
+ *
+ * PARAMETERS:
+ *
+ *   Mode  : The new clock mode.
+ *
+ *   Scale : The factor to apply to delays in VCLOCK_SCALED mode.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+void vclock_set_mode(VClockModeType Mode, double Scale);
+
+/* =============================================================================
+ * FUNCTION: vclock_nap
+ *
+ * DESCRIPTION:
+ * Account for a delay requested by the game and get the time the display
+ * module should wait for. Every nap must call this.
+ *
+ * PARAMETERS:
+ *
+ *   delay : The delay requested in milliseconds.
+ *
+ * RETURN VALUE:
+ *
+ *   The time to wait in milliseconds. This is 0 if there is to be no delay.
+ */
+int vclock_nap(int delay);
+
+/* =============================================================================
+ * FUNCTION: vclock_report
+ *
+ * DESCRIPTION:
+ * Write the number of delays, the total time asked for and the total time
+ * waited to stderr, if there were any delays.
+ *
+ * PARAMETERS:
+ *
+ *   None.
+ *
+ * RETURN VALUE:
+ *
+ *   None.
+ */
+void vclock_report(void);
+
+#endif